@@ -3,19 +3,87 @@
 //
 
 #include "Sliggy.h"
+#include <SDL_error.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <math.h>
+#if !defined(SLIGGY_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define SL_USE_SSE2
+#endif
+
+#include <SDL_atomic.h>
+#include <SDL_thread.h>
+#include <SDL_log.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define strtok_r strtok_s
+#endif
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#define SL_HOT_RELOAD
+#endif
 
 // Inner flags
 #define SL_INNERFLAG_ACTIVE 0b1
 #define SL_INNERFLAG_ABSOLUTE 0b1000
+#define SL_INNERFLAG_DAMAGED 0b10000 // changed since the retained layer last saw it
+#define SL_INNERFLAG_IN_USE 0b100000 // slot holds a live element, freed slots sit on the free list
 
 // Other ~fun~ macros
 
 #define NUM_INDICES 54
 #define NUM_VERTICES 16
 #define MAP_INIT 32
+#define TEXT_MAP_INIT 8
+#define MAP_MAX_LOAD 0.75f // grow and rehash past this
+#define ELEMENT_PAGE_SIZE 64
+#define HANDLE_INDEX_BITS 32 // rest of the handle is the slot's generation
+#define HANDLE_INDEX_MASK 0xFFFFFFFFu
+#define HANDLE_GENERATION_MAX 0xFFFFFFFFu // a slot freed at this generation is retired instead of wrapping
+#define INTERN_INIT 256
+#define INTERN_PAGE_SIZE 4096
+#define FONT_FILE_MAGIC "SLFN"
+#define FONT_FILE_VERSION 4
+#define FONT_PAGE_SHIFT 8 // codepoint lookup pages hold 256 codepoints
+#define FONT_PAGE_COUNT (0x110000 >> FONT_PAGE_SHIFT)
+#define UTF8_REPLACEMENT 0xFFFD
+#define KERNING_MAX_LOAD 0.5f
+#define SDF_SIZE_CACHE 8 // sizes of a distance field font kept rasterised, unused ones go oldest first past this
+#define SDF_PAGE_MIN_WIDTH 256
+#define SDF_FAR 1e20f // squared distance for "no feature yet", finite so the transform doesn't hit inf - inf
+#define ATLAS_INIT 16
+#define ATLAS_PADDING 1 // pixels between packed rects so filtering doesn't bleed
+#define BLUEPRINT_FILE_MAGIC "SLBP"
+#define BLUEPRINT_FILE_VERSION 1
+#define BLUEPRINT_INIT 16
+#define BLUEPRINT_SKIN 0
+#define BLUEPRINT_FONT 1
+#define HOT_RELOAD_POLL_MS 100
+#define HOT_RELOAD_SETTLE_MS 50 // editors save in bursts, wait for it to go quiet before parsing
 #define MAX_TEXT_OBJS 16 // revisit this?
+#define TEXT_CAPACITY_STEP 16 // text buffers grow in steps of this many glyphs, so reused ones fit more often
+#define SHAPE_CACHE_DEFAULT (256 << 10) // bytes of shaped runs kept around
+#define SHAPE_CACHE_MAX_GLYPHS 64 // longer text is rarely repeated, it's just shaped in place
+#define SHAPE_CACHE_BUCKETS 64
+#define FRAME_ARENA_DEFAULT (2 << 20) // bytes, enough for a few full screens of dialogue
+#define FRAME_ARENA_MIN_VERTICES 256
+#define BATCH_LOOKBACK 32 // how many batches back a draw can be merged into
+#define BATCH_MAX_RECT_TESTS 256 // past this many rects we just assume an overlap
+#define DAMAGE_MAX_RECTS 16 // past this many the damage collapses into one rect
+#define JOB_THREADS_MAX 16
+
+// Glyph flags
+#define SL_GLYPH_KERNS 0b1 // first glyph of at least one kerning pair
 
 #define WHITE { 0xFF, 0xFF, 0xFF, 0xFF }
 #define RED { 0xFF, 0x00, 0x00, 0xFF }
@@ -28,30 +96,51 @@ struct SL_TextObject;
 struct SL_TextObjBuilder;
 
 struct SL_UIEB_INNER_ {
-    const char* name;
+    SL_Id name;
     float x, y, w, h; // Expected as screen coordinates, 0-1
     int xab, yab, wab, hab; // absolute values
     int flags;
     SDL_Texture* skin;
-    SDL_Texture* font;
+    SDL_Rect skin_region; // w == 0 for the whole texture
+    SL_Font* font; // holds a reference
+    SL_TextAlign align; // for text added from here on
     struct SL_TextObjectBuilder* text_builders;
     int num_text_objects;
+
+    // Virtual list, only used when list_callback is set
+    SL_ListRowCallback list_callback;
+    void* list_userdata;
+    int list_rows;
+    int list_row_height;
+    float list_text_size;
+    int list_columns[SL_LIST_MAX_COLUMNS];
+    int list_column_count;
 };
 
 struct SL_UIE_INNER_ {
-    const char* name;
+    SL_Id id;
+    const char* name; // interned, lives until SL_Quit
     SDL_Texture* texture_skin;
     int skin_step_x;
     int skin_step_y;
+    float skin_uv[4]; // u0, v0, u1, v1 of the part of the texture the skin is in
+    SDL_Vertex skin_vertices[NUM_VERTICES]; // baked whenever the rect or skin changes
+    SDL_Color tint; // multiplies the skin and every text colour
 
     SDL_Rect src_rect;
     unsigned short flags;
-    SDL_Texture* font;
+    SL_Font* font; // default for text objects, holds a reference
 
-    struct SL_TextObject* TextObjectMap;
-    int* TextObjectIterator;
-    int textMapLimit;
-    int textMapCount;
+    struct SL_TextObject* TextObjects; // dense, in the order they were added. Past textCount are parked ones
+    int textCount;
+    int textLimit;
+    struct SL_NameIndex* TextObjectMap; // interned id -> index into TextObjects
+    struct SL_ListState* list; // NULL unless this is a virtual list
+
+    int slot; // index in the element pages
+    uint32_t generation; // bumped whenever the slot is freed, so old handles stop resolving
+    int next_free; // next slot on the free list while this one is on it
+    int draw_index; // where it is in DrawOrder
 };
 
 typedef struct SL_Glyph {
@@ -59,15 +148,142 @@ typedef struct SL_Glyph {
     char x_offset;
     char y_offset;
     unsigned char x_advance;
-    char raw_char;
+    unsigned char flags;
+    uint32_t codepoint;
     float u_min;
     float u_max;
     float v_min;
     float v_max;
 } SL_Glyph;
 
+/*
+ * The glyph fields layout and quad generation actually touch, split out of SL_Glyph into one array each.
+ * Boxes are (left, right, top, bottom) and UVs (u_min, u_max, v_min, v_max) so either is a single
+ * vector load. Two blank entries follow the font's glyphs for codepoints it can't draw, the second is a space.
+ */
+typedef struct SL_GlyphTable {
+    float* boxes;
+    float* uvs;
+    uint32_t* codepoints;
+    unsigned char* advances;
+    unsigned char* flags;
+    int blank; // index of the first blank entry
+} SL_GlyphTable;
+
+typedef struct SL_Kerning {
+    int32_t first;
+    int32_t second;
+    int32_t amount;
+} SL_Kerning;
+
+/*
+ * Everything loaded from one font file. Glyphs and kernings either come from parsing a .fnt
+ * or point straight into a mapped binary font, in which case mapping is set.
+ * Fonts are shared through the registry, keyed by path and reference counted.
+ */
+struct SL_FONT_INNER_ {
+    SL_Id path;
+    int refs;
+    int generation; // bumped whenever the glyph data changes under existing text
+    SDL_Texture* texture;
+    SL_Glyph* glyphs; // in file order, found through the lookup tables below
+    int count;
+    SL_GlyphTable table; // same order as glyphs
+
+    // Codepoint -> glyph index + 1, 0 where the font has no glyph. ASCII gets its own table so it's a single load,
+    // everything else goes through a two level page table that only allocates pages that have glyphs
+    uint16_t ascii[128];
+    uint16_t* page_index; // codepoint >> FONT_PAGE_SHIFT -> page + 1, NULL if the font is ASCII only
+    uint16_t* pages;
+    int page_count;
+    int missing; // glyph drawn for codepoints the font doesn't have, -1 for nothing
+
+    // Kerning pairs keyed on (first << 21) | second, 0 marks an empty slot. Only probed for glyphs with SL_GLYPH_KERNS
+    uint64_t* kerning_keys;
+    int16_t* kerning_amounts;
+    int kerning_mask;
+    int kerning_enabled;
+
+    SL_Kerning* kernings;
+    int kerning_count;
+    float size;
+    float tex_width;
+    float tex_height;
+    int line_height;
+    int base; // baseline, from the top of a line
+    SDL_Rect atlas_region; // where the font's page went in an atlas, w == 0 if it hasn't
+    float atlas_page_w;
+    float atlas_page_h;
+    void* mapping;
+    size_t mapping_size;
+
+    // Distance field fonts keep the field on the CPU and draw each size in use from its own small coverage texture
+    float sdf_range; // distance in atlas pixels the field covers from 0 to 255, 0 for bitmap fonts
+    int sdf_multi; // msdf, the distance is the median of r, g and b
+    unsigned char* sdf; // one byte per atlas pixel, 128 on the outline. NULL until the atlas is loaded
+    int sdf_width;
+    int sdf_height;
+    struct SL_SdfSize* sdf_sizes;
+    int sdf_size_count;
+};
+
+// One size of a distance field font, rasterised once and shared by every text drawn at it
+typedef struct SL_SdfSize {
+    int px; // 0 when the entry is free
+    int refs; // text objects drawing from it, kept around for a while at 0
+    Uint32 last_used;
+    SDL_Texture* texture;
+    int width;
+    int height;
+    float* uvs; // same layout as the glyph table's, into texture
+} SL_SdfSize;
+
+// A short text shaped once for a font, size and wrap width, shared by every text object showing the same string.
+// The glyphs, lines and string live in the same block, right after the run
+typedef struct SL_ShapedRun {
+    struct SL_ShapedRun* next; // same bucket
+    struct SL_ShapedRun* newer; // least recently used order, shape_newest is the head
+    struct SL_ShapedRun* older;
+    uint32_t hash;
+    SL_Font* font; // no reference, a font's runs are dropped before it goes
+    int generation; // font->generation it was laid out against
+    float scale;
+    int limit; // wrap width the lines were broken for, less the text's x
+    SDL_atomic_t refs; // text objects on it, which can let go from the job threads
+    size_t bytes;
+    int length;
+    int num_lines;
+    SL_TextLine* lines;
+    uint16_t* glyphs;
+    char* text;
+} SL_ShapedRun;
+
+/*
+ * Binary font layout, written by SL_CompileFont: this header, then glyph_count SL_Glyphs
+ * and kerning_count SL_Kernings at the given offsets. Native endianness - it's a build artifact.
+ */
+typedef struct SL_FontFileHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t glyph_size; // sizeof(SL_Glyph) when written, a mismatch means a different ABI
+    uint32_t glyph_count;
+    uint32_t kerning_count;
+    uint32_t glyph_offset;
+    uint32_t kerning_offset;
+    float size;
+    float tex_width;
+    float tex_height;
+    int32_t line_height;
+    int32_t base;
+    float sdf_range;
+    int32_t sdf_multi;
+} SL_FontFileHeader;
+
 typedef struct SL_TextObjectBuilder {
-    const char* id;
+    SL_Id id;
+    SL_Font* font; // builder font when the text was added, NULL means the element's
+    SL_TextAlign align;
+    SDL_Color color;
     const char* text;
     int x;
     int y;
@@ -75,34 +291,323 @@ typedef struct SL_TextObjectBuilder {
 } SL_TextObjBuilder;
 
 typedef struct SL_TextObject {
-    const char* id;
-    SL_Glyph* text;
-    int* word_widths; // width of each word respectively - used for word wrapping
-    short length; // length in characters
-    short num_words; // # of words separated by whitespace - includes punctuation
+    SL_Id id;
+    SL_Font* font; // holds a reference
+    uint16_t* glyphs; // indices into the font's glyph table
+    int length; // length in codepoints
+    int capacity; // glyphs the glyph buffer has room for, buffers outlive the text in a freed slot
     float scale; // precalculated scale factor - desired size of the text / font pt size
     SDL_Color c;
     int x_start;
     int y_start;
+    SL_TextAlign align;
+
+    // Typewriter reveal - only the first visible glyphs get drawn, the rest of the geometry just sits there
+    int visible;
+    float reveal_rate; // glyphs per second, 0 when nothing is being revealed
+    float reveal_progress; // fraction of a glyph carried over between updates
+    SL_RevealCallback on_reveal;
+    void* reveal_userdata;
+
+    // Cached layout - only redone when the text, its metrics or the wrap width change
+    SL_TextLine* lines;
+    int num_lines;
+    int line_limit;
+    int layout_width; // wrap width the lines were broken for
+    int layout_dirty;
+
+    // Shared glyphs and lines from the shape cache. While on a run, glyphs and lines point into it and the text's
+    // own buffers are put aside, anything that changes them copies the run over first
+    struct SL_ShapedRun* run;
+    uint16_t* own_glyphs;
+    SL_TextLine* own_lines;
+
+    // Cached geometry - rebuilt only when dirty
+    SDL_Vertex* vertices;
+    int* indices; // relative to the first vertex of this text object
+    int quad_capacity; // quads the vertex and index buffers have room for
+    SDL_Rect bounds;
+    int font_generation; // font->generation the cache was built against
+    int dirty;
+    int sdf_size; // font->sdf_sizes entry the glyphs are drawn from, -1 for bitmap fonts
 } SL_TextObject;
 
-typedef enum HashMapType {
-    HASHMAP_TYPE_UI_ELEMENT,
-    HASHMAP_TYPE_TEXT_ELEMENT
-} HashMapType;
-
-// Font stuff
-static int font_start = 0;
-static int font_count;
-static SL_Glyph* Glyphs = NULL;
-static float font_size;
-static float font_tex_width;
-static float font_tex_height;
-static int lineHeight;
-
-static SL_TextObject
-CreateTextObject(const char *raw_text, float desired_size, int x_, int y_);
+// A virtual list only ever has as many rows as fit on screen. Row r always goes in slot r % slot_count, so a row
+// that's still on screen after a scroll keeps its slot and only the rows scrolling in get filled again
+typedef struct SL_ListSlot {
+    int row; // -1 when empty
+    int generation; // font->generation the glyphs were looked up in
+    SL_TextObject columns[SL_LIST_MAX_COLUMNS];
+} SL_ListSlot;
+
+typedef struct SL_ListState {
+    SL_ListRowCallback callback;
+    void* userdata;
+    int row_count;
+    int row_height;
+    float text_size;
+    int scroll; // pixels from the top of the first row
+    int columns[SL_LIST_MAX_COLUMNS]; // x of each column
+    int column_count;
+    SL_ListSlot* slots;
+    int slot_count;
+} SL_ListState;
+
+// One SL_DrawElement produces a command per texture it touches (skin, font)
+typedef struct SL_DrawCommand {
+    SDL_Texture* texture;
+    int first_index;
+    int num_indices;
+    SDL_Rect bounds;
+    int next; // next command in the same batch, -1 terminates
+} SL_DrawCommand;
+
+typedef struct SL_Batch {
+    SDL_Texture* texture;
+    SDL_Rect bounds; // union of every command in the batch
+    int head;
+    int tail;
+} SL_Batch;
+
+/*
+ * Open addressed name -> index map. Slots only hold the index into whatever dense storage owns the items,
+ * so growing the map never moves the items themselves.
+ * Callers hand in the hash, so interned names never get rehashed and usually match on pointer equality.
+ */
+typedef struct SL_NameIndex {
+    uint32_t* hashes;
+    const char** keys;
+    int* values;
+    uint32_t* occupied; // one bit per slot
+    int limit; // always a power of two
+    int count;
+} SL_NameIndex;
+
+/*
+ * Load time texture atlas. Skins and font pages are queued with their surfaces, then SL_BuildAtlas packs
+ * them tallest first onto as few pages as it can, one skyline per page.
+ */
+typedef struct SL_AtlasEntry {
+    SL_Id name; // skins only
+    SL_Font* font; // fonts only, holds a reference
+    SDL_Surface* surface; // the caller's, only read while building
+    SDL_Rect region;
+    int page;
+} SL_AtlasEntry;
+
+// Top edge of the packed area over [x, x + w)
+typedef struct SL_SkylineNode {
+    int x;
+    int y;
+    int w;
+} SL_SkylineNode;
+
+typedef struct SL_AtlasPage {
+    SDL_Texture* texture;
+    SL_SkylineNode* skyline; // left to right, covering the page width
+    int nodes;
+    int node_limit;
+} SL_AtlasPage;
+
+struct SL_ATLAS_INNER_ {
+    int page_w;
+    int page_h;
+    SL_AtlasEntry* entries;
+    int count;
+    int limit;
+    SL_AtlasPage* pages;
+    int page_count;
+    int built;
+};
+
+/*
+ * Blueprint records. Strings are offsets into whatever buffer the records came from, 0 for none - the text
+ * loader points them into the file it parsed in place, the compiled form carries its own string table.
+ * Compiled blueprints are these written out as they are: a header, the resources, the elements, every
+ * element's texts back to back in element order, then the strings. Native endianness, like binary fonts.
+ */
+typedef struct SL_BlueprintResource {
+    uint32_t kind; // BLUEPRINT_SKIN or BLUEPRINT_FONT
+    uint32_t name;
+    uint32_t path;
+    uint32_t texture; // image handed to the texture loader
+    SDL_Rect region; // skins, w == 0 for the whole texture
+} SL_BlueprintResource;
+
+typedef struct SL_BlueprintElement {
+    uint32_t name;
+    uint32_t skin; // resource names
+    uint32_t font;
+    int32_t flags;
+    int32_t align;
+    int32_t text_count;
+    float rel[4];
+    SDL_Rect rect;
+} SL_BlueprintElement;
+
+typedef struct SL_BlueprintText {
+    uint32_t id;
+    uint32_t value;
+    uint32_t font;
+    int32_t align;
+    int32_t x;
+    int32_t y;
+    float size;
+    SDL_Color color;
+} SL_BlueprintText;
+
+typedef struct SL_BlueprintFileHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t element_size; // sizeof(SL_BlueprintElement) when written, a mismatch means a different ABI
+    uint32_t resource_count;
+    uint32_t element_count;
+    uint32_t text_count;
+    uint32_t resource_offset;
+    uint32_t element_offset;
+    uint32_t text_offset;
+    uint32_t string_offset;
+    uint32_t string_size;
+} SL_BlueprintFileHeader;
+
+// A loaded resource, found by name while the elements after it are created
+typedef struct SL_BlueprintSlot {
+    SL_Id name;
+    int kind;
+    SDL_Texture* texture;
+    SDL_Rect region;
+    SL_Font* font; // holds a reference until the load is done
+} SL_BlueprintSlot;
+
+// Where SL_CompileBlueprint collects the records before writing them
+typedef struct SL_BlueprintOutput {
+    SL_BlueprintResource* resources;
+    int resource_count;
+    int resource_limit;
+    SL_BlueprintElement* elements;
+    int element_count;
+    int element_limit;
+    SL_BlueprintText* texts;
+    int text_count;
+    int text_limit;
+    char* strings;
+    size_t string_size;
+    size_t string_limit;
+} SL_BlueprintOutput;
+
+typedef struct SL_BlueprintState {
+    const char* path;
+    const char* strings; // what the record offsets point into
+    SL_TextureLoader loader;
+    void* userdata;
+    SL_BlueprintSlot* resources;
+    int resource_count;
+    int resource_limit;
+    int created;
+    int reload; // named elements that already exist are rebuilt in place, unnamed ones are left alone
+    SL_BlueprintOutput* out; // set when compiling instead of loading
+} SL_BlueprintState;
+
+// Kinds of file Sliggy has loaded something from
+#define SOURCE_FONT 0
+#define SOURCE_BLUEPRINT 1
+#define SOURCE_TEXTURE 2
+
+/*
+ * Every font, blueprint and blueprint image loaded so far. Doubles as the cache that makes blueprints
+ * sharing an image ask the texture loader for it once, and is what the hot reloader watches.
+ */
+typedef struct SL_SourceFile {
+    int kind;
+    const char* path; // interned, so it stays put for the reload thread
+    const char* name; // past the last slash of path
+    int wd; // inotify watch on the file's directory, -1 if not watched
+    SL_TextureLoader loader; // blueprints and textures
+    void* userdata;
+    SDL_Texture* texture; // textures, whatever the loader last returned
+} SL_SourceFile;
+
+// A changed file the reload thread has parsed, waiting for SL_BeginFrame to swap it in
+typedef struct SL_ReloadResult {
+    int source;
+    int ok;
+    char error[256];
+    SL_Font font;
+    SL_BlueprintOutput blueprint; // text blueprints
+    char* compiled; // compiled blueprints, the whole file
+    size_t compiled_size;
+    struct SL_ReloadResult* next;
+} SL_ReloadResult;
+
+// Font registry - every font file is loaded once no matter how many builders ask for it
+#define FONT_INIT 8
+static SL_NameIndex FontMap; // interned path -> index into Fonts
+static SL_Font** Fonts = NULL; // NULL holes where fonts were released
+static int fontCount = 0;
+static int fontLimit = 0;
+
+static int parseFontText(SL_Font* font, const char* path);
+static int mapFontBinary(SL_Font* font, const char* path);
+static int loadFont(SL_Font* font, const char* path);
+static void releaseFont(SL_Font* font);
+static int sdfAcquire(SL_Font* font, float scale);
+static void sdfRelease(SL_Font* font, int idx);
+static void sdfFreeSize(SL_SdfSize* size);
+static void sdfRefresh(SL_Font* font);
+static void buildGlyphLookup(SL_Font* font);
+static int glyphIndex(const SL_Font* font, uint32_t codepoint);
+static void buildKerningLookup(SL_Font* font);
+static void buildGlyphTable(SL_Font* font);
+static uint16_t glyphSlot(const SL_Font* font, uint32_t codepoint);
+static int kerningAmount(const SL_Font* font, uint32_t first, uint32_t second);
+
+static void InitTextObject(SL_TextObject* obj, SL_Font* font, const char *raw_text, float desired_size, int x_, int y_,
+                           int width);
+static void ParkTextObject(SL_TextObject* ptr);
 static void DestroyTextObject(SL_TextObject* ptr);
+static size_t textObjectBytes(const SL_TextObject* t);
+static size_t nameIndexBytes(const SL_NameIndex* map);
+static int glyphAdvance(const SL_TextObject* t, int i);
+static int utf8Length(const char* str);
+static void reserveText(SL_TextObject* t, int length);
+static void LayoutText(SL_TextObject* t, int width);
+static int RelayoutText(SL_TextObject* t, int width, int from, int settled, int delta);
+static SL_ShapedRun* shapeFind(const SL_Font* font, float scale, int limit, const char* text, uint32_t hash);
+static void shapeAdd(const SL_TextObject* t, int limit, const char* text, uint32_t hash);
+static void shapeTrim(size_t budget);
+static void shapePurgeFont(const SL_Font* font);
+static void shapeCacheQuit(void);
+static void attachRun(SL_TextObject* t, SL_ShapedRun* run, int width);
+static void releaseRun(SL_TextObject* t);
+static void unshareText(SL_TextObject* t);
+static void EmitQuads(SL_TextObject* t, int start, int end, int textx, int texty, SDL_Color c, float* bounds);
+static void BuildTextGeometry(SL_TextObject* t, const SL_UIElement* element);
+static void EmitLine(SL_TextObject* t, const SL_UIElement* element, int l, SDL_Color color, float* bounds);
+static void PatchTextGeometry(SL_TextObject* t, const SL_UIElement* element, int from, int to, int delta);
+static void PrepareText(SL_TextObject* t, const SL_UIElement* element);
+static void MarkTextDirty(SL_UIElement* element, int relayout);
+static void RecolorText(SL_TextObject* t, SDL_Color color);
+static void revealGlyphs(SL_UIElement* element, SL_TextObject* t, int count);
+static void drawText(SL_TextObject* t);
+static SDL_Texture* textTexture(const SL_TextObject* t);
+static const float* textUvs(const SL_TextObject* t);
+static void updateList(const SL_UIElement* element);
+static void freeList(SL_UIElement* element);
+static void BakeSkin(SL_UIElement* element);
+static void applySkin(SL_UIElement* element, SDL_Texture* skin, const SDL_Rect* region);
+static SL_UIElement* createElement(const SL_UIElementBuilder* builder);
+static void initElement(SL_UIElement* element, const SL_UIElementBuilder* builder);
+static void clearElement(SL_UIElement* element);
+static void releaseElementSlot(SL_UIElement* element);
+static uint32_t compileString(SL_BlueprintState* state, uint32_t offset);
+static void appendRecord(void** records, int* count, int* limit, const void* record, size_t size);
+static void blueprintOutputInit(SL_BlueprintOutput* out);
+static void blueprintOutputFree(SL_BlueprintOutput* out);
+static int walkBlueprint(SL_BlueprintState* state, const SL_BlueprintResource* resources, int resource_count,
+                         const SL_BlueprintElement* elements, int element_count, const SL_BlueprintText* texts);
+static void rebuildElement(SL_UIElement* element, const SL_UIElementBuilder* builder);
+static void TintSkin(SL_UIElement* element);
+static SDL_Color modulateColor(SDL_Color c, SDL_Color tint);
 
 // Static members
 
@@ -111,19 +616,151 @@ static int screen_height;
 static int global_flags = 0;
 static SDL_Renderer* render_context;
 
-// Element hash map
-static int mapLimit;
-static int mapCount;
-static SL_UIElement* ElementHashMap;
+// Frame batcher - all geometry for a frame lands here and is flushed in SL_EndFrame
+// The buffers are carved out of one fixed block, if a frame outgrows it we just flush early
+static int in_frame = 0;
+static void* frame_arena = NULL;
+static int frame_arena_capacity = FRAME_ARENA_DEFAULT;
+static int frame_arena_high_water = 0;
+static SDL_Vertex* batch_vertices = NULL;
+static int batch_vertex_count = 0;
+static int batch_vertex_limit = 0;
+static int* batch_indices = NULL;
+static int batch_index_count = 0;
+static int batch_index_limit = 0;
+static int* flush_indices = NULL; // same size as batch_indices
+static SL_DrawCommand* batch_commands = NULL;
+static int batch_command_count = 0;
+static int batch_command_limit = 0;
+static SL_Batch* batches = NULL; // same size as batch_commands
+static SL_FrameStats frame_stats;
+// Running totals for what can't be found by walking globals - text objects and unmanaged elements
+static SL_MemoryStats memory_stats;
+
+// Shape cache - runs hashed by font, size, width and string, chained per bucket and kept in use order
+static SL_ShapedRun** shape_buckets = NULL;
+static int shape_bucket_count = 0;
+static SL_ShapedRun* shape_newest = NULL;
+static SL_ShapedRun* shape_oldest = NULL;
+static size_t shape_budget = SHAPE_CACHE_DEFAULT;
+static SL_ShapeCacheStats shape_stats;
+
+// Heap allocations all go through these so the frame stats can count them. Atomic since the hot reload thread allocates too
+static SDL_atomic_t allocation_count;
+
+static void* slMalloc(size_t size) {
+    SDL_AtomicAdd(&allocation_count, 1);
+    return malloc(size);
+}
+
+static void* slCalloc(size_t count, size_t size) {
+    SDL_AtomicAdd(&allocation_count, 1);
+    return calloc(count, size);
+}
+
+static void* slRealloc(void* ptr, size_t size) {
+    SDL_AtomicAdd(&allocation_count, 1);
+    return realloc(ptr, size);
+}
+
+static int batchReserve(int num_vertices, int num_indices, SDL_Vertex** vertices, int** idxs);
+static int batchQuadsAvailable(int wanted);
+static void batchPushCommand(SDL_Texture* texture, int first_index, int num_indices, SDL_Rect bounds);
+static void batchFlush(void);
+static void frameArenaFree(void);
+
+// Retained mode - a screen sized layer of everything active, only redrawn where damaged
+static SDL_Texture* retained_layer = NULL;
+static SDL_Rect damage[DAMAGE_MAX_RECTS];
+static int damage_count = 0;
+
+static void damageRect(SDL_Rect rect);
+static void damageElement(SL_UIElement* element);
+static SDL_Rect elementBounds(const SL_UIElement* element);
 
-// some helpers for hash stuff... weird pointer crap
-static void *getVoidPtrOffset(void *ptr, HashMapType type, int idx);
-static int itemAtAddressExists(void* ptr);
+// Every file something was loaded from, and the hot reloader watching them
+static SL_SourceFile* Sources = NULL;
+static int sourceCount = 0;
+static int sourceLimit = 0;
+static SDL_mutex* reload_lock = NULL; // guards Sources and reload_results while the reload thread runs
+static SDL_Thread* reload_thread = NULL;
+static SDL_atomic_t reload_quit;
+static SDL_atomic_t reload_ready; // results are waiting
+static SL_ReloadResult* reload_results = NULL; // newest first
+static int reload_fd = -1;
 
+static int sourceAdd(int kind, const char* path, SL_TextureLoader loader, void* userdata);
+static SDL_Texture* sourceTexture(const char* path, SL_TextureLoader loader, void* userdata);
+static void sourcesQuit(void);
+static void hotReloadWatch(SL_SourceFile* source);
+static void hotReloadApply(void);
+static void reloadResultFree(SL_ReloadResult* result);
 
-static void *addItemToMap(void *map_, const char *name, HashMapType type, int *count, int *limit, int *index);
-void *getItemFromMap(void *map_, const char *name, const int *limit, enum HashMapType type);
-static int hashName(const char* name);
+// Job pool - text layout and geometry for many elements at once. Each worker starts on its own run of the
+// element list and steals from the back of the others' once it's done
+typedef struct SL_JobQueue {
+    SDL_SpinLock lock;
+    int head; // owner takes from here
+    int tail; // one past the last job, thieves take from here
+} SL_JobQueue;
+
+static SDL_Thread* job_threads[JOB_THREADS_MAX];
+static int job_thread_count = 0; // workers, not counting whoever calls SL_PrepareElements
+static SL_JobQueue job_queues[JOB_THREADS_MAX]; // queue 0 is the calling thread's
+static SDL_sem* job_wake = NULL;
+static SDL_sem* job_done = NULL; // posted once when the last job of a batch finishes
+static SDL_atomic_t job_pending;
+static SDL_atomic_t job_quit;
+static SL_UIElement** job_elements = NULL;
+static int job_element_limit = 0;
+static SDL_SpinLock text_bytes_lock; // memory_stats.text, jobs can grow text buffers
+
+static void reserveJobElements(int count);
+static void runElementJobs(int count);
+static void textBytesChanged(long delta);
+
+// Elements live in fixed size pages so pointers to them stay valid as more get created. Freed slots go on a
+// free list with their text buffers still attached, so churning through elements settles into no allocations
+static SL_UIElement** ElementPages = NULL;
+static int elementPageCount = 0;
+static int elementCount = 0; // slots handed out so far, live or free
+static int elementFreeList = -1; // most recently freed slot
+static int elementFreeCount = 0;
+static int* ElementById = NULL; // interned id -> element index, -1 if there isn't one
+static int elementByIdLimit = 0;
+// Live slots in creation order, which is what the retained layer paints in since slots get reused out of order.
+// Freed elements leave a -1 behind until there are enough of those to be worth compacting
+static int* DrawOrder = NULL;
+static int drawOrderCount = 0;
+static int drawOrderLimit = 0;
+static int drawOrderHoles = 0;
+
+static SL_UIElement* elementAt(int idx);
+static SL_UIElement* allocElement(void);
+static void reserveElements(int count);
+static void drawOrderAppend(SL_UIElement* element);
+
+// Interned names - every element name and text id is copied here once and referred to by SL_Id after that
+static SL_NameIndex InternMap; // name -> id
+static const char** intern_names = NULL; // id -> name
+static uint32_t* intern_hashes = NULL; // id -> precomputed hash
+static int intern_count = 0;
+static int intern_limit = 0;
+static char** intern_pages = NULL;
+static int intern_page_count = 0;
+static size_t intern_page_used = INTERN_PAGE_SIZE;
+
+static SL_Id findId(const char* name);
+static void internQuit(void);
+
+static uint32_t hashName(const char* name);
+static void nameIndexInit(SL_NameIndex* map, int limit);
+static void nameIndexClear(SL_NameIndex* map);
+static void nameIndexFree(SL_NameIndex* map);
+static int nameIndexFind(const SL_NameIndex* map, const char* name, uint32_t hash);
+static void nameIndexInsert(SL_NameIndex* map, const char* name, uint32_t hash, int value);
+static void nameIndexRemove(SL_NameIndex* map, const char* name, uint32_t hash);
+static SL_TextObject* findTextObject(const SL_UIElement* element, SL_Id id);
 
 const static SDL_Color Color_White = WHITE;
 const static SDL_Color Color_Red = RED;
@@ -146,7 +783,7 @@ const static int indices[NUM_INDICES] = {
 
 SL_UIElementBuilder* SL_CreateBuilder(SDL_Texture* skin) {
 
-    SL_UIElementBuilder* ptr = malloc(sizeof(SL_UIElementBuilder));
+    SL_UIElementBuilder* ptr = slMalloc(sizeof(SL_UIElementBuilder));
 
     ptr->x = 0;
     ptr->y = 0;
@@ -157,6 +794,9 @@ SL_UIElementBuilder* SL_CreateBuilder(SDL_Texture* skin) {
     ptr->wab = 0;
     ptr->hab = 0;
     ptr->num_text_objects = 0;
+    ptr->name = SL_NO_ID;
+    ptr->font = NULL;
+    ptr->skin_region = (SDL_Rect){0, 0, 0, 0};
 
     if (skin != NULL) {
         ptr->skin = skin;
@@ -166,21 +806,27 @@ SL_UIElementBuilder* SL_CreateBuilder(SDL_Texture* skin) {
     }
 
     ptr->flags = SL_INNERFLAG_ACTIVE;
-    ptr->text_builders = calloc(MAX_TEXT_OBJS, sizeof(SL_TextObjBuilder));
+    ptr->align = SL_TEXT_ALIGN_LEFT;
+    ptr->text_builders = slCalloc(MAX_TEXT_OBJS, sizeof(SL_TextObjBuilder));
+    ptr->list_callback = NULL;
 
     return ptr;
 }
 
 void SL_BuilderAddTextObject(SL_UIElementBuilder *builder, const char *text, int x_, int y_, float size, const char *id_) {
-    const char* id;
+    SL_Id id;
     if (!id_) {
-        id = text;
+        id = SL_Intern(text);
     }
     else {
-        id = id_;
+        id = SL_Intern(id_);
     }
+    SL_RetainFont(builder->font);
     SL_TextObjBuilder b = {
             .id = id,
+            .font = builder->font,
+            .align = builder->align,
+            .color = Color_White,
             .size = size,
             .text = text,
             .x = x_,
@@ -189,6 +835,27 @@ void SL_BuilderAddTextObject(SL_UIElementBuilder *builder, const char *text, int
     builder->text_builders[builder->num_text_objects++] = b;
 }
 
+void SL_BuilderSetList(SL_UIElementBuilder* builder, int row_count, int row_height, float text_size,
+                       SL_ListRowCallback callback, void* userdata) {
+    builder->list_callback = callback;
+    builder->list_userdata = userdata;
+    builder->list_rows = row_count > 0 ? row_count : 0;
+    builder->list_row_height = row_height > 0 ? row_height : 1;
+    builder->list_text_size = text_size;
+    if (builder->list_column_count == 0) {
+        builder->list_columns[0] = 0;
+        builder->list_column_count = 1;
+    }
+}
+
+void SL_BuilderSetListColumns(SL_UIElementBuilder* builder, const int* x, int count) {
+    if (count > SL_LIST_MAX_COLUMNS) count = SL_LIST_MAX_COLUMNS;
+    for (int i = 0; i < count; i++) {
+        builder->list_columns[i] = x[i];
+    }
+    builder->list_column_count = count > 0 ? count : 0;
+}
+
 void SL_BuilderSetDimensionsAbsolute(SL_UIElementBuilder* builder, const int* x, const int* y, const int* w, const int* h) {
     if (x != NULL)
         builder->xab = *x;
@@ -213,11 +880,21 @@ void SL_BuilderSetDimensionsRelative(SL_UIElementBuilder* builder, const float*
 }
 
 void SL_BuilderSetName(SL_UIElementBuilder* builder, const char* name) {
-    builder->name = name;
+    builder->name = SL_Intern(name);
 }
 
 void SL_BuilderSetTexture(SL_UIElementBuilder* builder, SDL_Texture* texture) {
     builder-> skin = texture;
+    builder->skin_region = (SDL_Rect){0, 0, 0, 0};
+}
+
+void SL_BuilderSetSkinRegion(SL_UIElementBuilder* builder, SDL_Texture* texture, const SDL_Rect* region) {
+    builder->skin = texture;
+    builder->skin_region = region ? *region : (SDL_Rect){0, 0, 0, 0};
+}
+
+void SL_BuilderSetTextAlign(SL_UIElementBuilder* builder, SL_TextAlign align) {
+    builder->align = align;
 }
 
 void SL_BuilderSetActive(SL_UIElementBuilder* builder, int active) {
@@ -229,485 +906,4271 @@ void SL_BuilderSetActive(SL_UIElementBuilder* builder, int active) {
     }
 }
 
-#pragma clang diagnostic push
-#pragma ide diagnostic ignored "cert-err34-c"
-#pragma ide diagnostic ignored "cppcoreguidelines-narrowing-conversions"
-// Only supports one font stored statically right now
 void SL_BuilderSetFont(SL_UIElementBuilder* builder, SDL_Texture* tex, const char* path) {
-    FILE* file = fopen(path, "r");
+    SL_Font* font = SL_LoadFont(tex, path);
+    if (!font) {
+        return;
+    }
+    SL_ReleaseFont(builder->font);
+    builder->font = font;
+}
+
+void SL_BuilderUseFont(SL_UIElementBuilder* builder, SL_Font* font) {
+    SL_RetainFont(font);
+    SL_ReleaseFont(builder->font);
+    builder->font = font;
+}
 
-    char* str = malloc(128);
+// Fonts
 
-    while (fgets(str, 128, file)) {
-        // printf("%s\n", str);
-        char* c = strtok(str, " ");
-        if (strcmp(c, "chars") == 0) {
-            c = strtok(NULL, " ");
-            c = strtok(c, "=");
-            c = strtok(NULL, "=");
-            font_count = atoi(c);
-            // printf("Font count: %d\n", font_count);
-            Glyphs = calloc(font_count, sizeof(SL_Glyph));
-            continue;
-        }
-        else if (strcmp(c, "info") == 0) {
-            c = strtok(NULL, " =");
-            do {
-                // THIS BREAKS IF THE FONT NAME HAS A SPACE
-                char* key = c;
-                char* val = strtok(NULL, " =");
-                if (strcmp(key, "size") == 0) {
-                    font_size = atof(val);
-                }
-            } while ((c = strtok(NULL, " =")));
+SL_Font* SL_LoadFont(SDL_Texture* tex, const char* path) {
+    if (!path) return NULL;
+    SL_Id id = SL_Intern(path);
+    if (fontLimit == 0) {
+        nameIndexInit(&FontMap, FONT_INIT);
+    }
+    int idx = nameIndexFind(&FontMap, intern_names[id], intern_hashes[id]);
+    if (idx >= 0) {
+        SL_Font* font = Fonts[idx];
+        // A font packed into an atlas draws from the atlas now, whatever texture its page started out in
+        if (tex && font->texture && tex != font->texture && font->atlas_region.w == 0) {
+            SDL_SetError("%s is already loaded with a different texture", path);
+            return NULL;
         }
-        else if (strcmp(c, "common") == 0) {
-            c = strtok(NULL, " =");
-            do {
-                char* key = c;
-                char* val = strtok(NULL, " =");
-                if (strcmp(key, "scaleW") == 0) {
-                    font_tex_width = atof(val);
-                }
-                else if (strcmp(key, "scaleH") == 0) {
-                    font_tex_height = atof(val);
-                }
-                else if (strcmp(key, "lineHeight") == 0) {
-                    lineHeight = atoi(val);
-                }
-            } while ((c = strtok(NULL, " =")));
+        if (tex && !font->texture) {
+            // Loaded without one first, like the distance field loader does
+            font->texture = tex;
+            SDL_SetTextureScaleMode(tex, SDL_ScaleModeNearest);
         }
-        else if (strcmp(c, "char") == 0) {
-            int id;
-            int x;
-            int y;
-            int w;
-            int h;
-            char xoff;
-            char yoff;
-            unsigned char xadv;
-            char raw;
-
-            c = strtok(NULL, " =");
-            do {
-                char* key = c;
-                char* val = strtok(NULL, " =");
-                // printf("Key: %s Val: %s\n", key, val);
-                if (strcmp(key, "id") == 0) {
-                    id = atoi(val);
-                    raw = (char)id;
-                    if (!font_start) {
-                        font_start = id;
-                    }
-                }
-                else if (strcmp(key, "x") == 0) {
-                    x = atoi(val);
-                }
-                else if (strcmp(key, "y") == 0) {
-                    y = atoi(val);
-                }
-                else if (strcmp(key, "width") == 0) {
-                    w = atoi(val);
-                }
-                else if (strcmp(key, "height") == 0) {
-                    h = atoi(val);
-                }
-                else if (strcmp(key, "xoffset") == 0) {
-                    xoff = atoi(val);
-                }
-                else if (strcmp(key, "yoffset") == 0) {
-                    yoff = atoi(val);
-                }
-                else if (strcmp(key, "xadvance") == 0) {
-                    xadv = atoi(val);
-                }
-            } while ((c = strtok(NULL, " =")));
-            SDL_Rect r = {x, y, w, h};
-            SL_Glyph g = {r, xoff, yoff, xadv};
+        font->refs++;
+        return font;
+    }
 
-            // TODO test UV
-            g.u_min = (float)x / font_tex_width;
-            g.u_max = (float)(x + w) / font_tex_width;
-            g.v_min = (float)(y + h) / font_tex_height;
-            g.v_max = (float)y / font_tex_height;
-            g.raw_char = raw;
-            Glyphs[id - font_start] = g;
-        }
+    SL_Font* font = slMalloc(sizeof(SL_Font));
+    if (loadFont(font, path) != 0) {
+        free(font);
+        return NULL;
+    }
+    font->path = id;
+    font->refs = 1;
+    font->generation = 0;
+    font->texture = tex;
+    if (tex) {
+        SDL_SetTextureScaleMode(tex, SDL_ScaleModeNearest);
     }
 
-    builder->font = tex;
+    for (idx = 0; idx < fontCount && Fonts[idx]; idx++);
+    if (idx == fontCount) {
+        if (fontCount == fontLimit) {
+            fontLimit = fontLimit ? fontLimit * 2 : FONT_INIT;
+            Fonts = slRealloc(Fonts, fontLimit * sizeof(SL_Font*));
+        }
+        fontCount++;
+    }
+    Fonts[idx] = font;
+    nameIndexInsert(&FontMap, intern_names[id], intern_hashes[id], idx);
+    sourceAdd(SOURCE_FONT, path, NULL, NULL);
+    return font;
+}
 
-    free(str);
-    fclose(file);
+void SL_RetainFont(SL_Font* font) {
+    if (font) font->refs++;
+}
 
+void SL_ReleaseFont(SL_Font* font) {
+    if (!font || --font->refs > 0) return;
+    const char* path = intern_names[font->path];
+    int idx = nameIndexFind(&FontMap, path, intern_hashes[font->path]);
+    if (idx >= 0) {
+        Fonts[idx] = NULL;
+        nameIndexRemove(&FontMap, path, intern_hashes[font->path]);
+    }
+    // The next font could land at the same address
+    shapePurgeFont(font);
+    releaseFont(font);
+    free(font);
 }
-#pragma clang diagnostic pop
 
-// Core / element definitions
+SDL_Texture* SL_FontTexture(const SL_Font* font) {
+    return font ? font->texture : NULL;
+}
 
-void SL_Init(SDL_Renderer* renderer, int screen_width_, int screen_height_, int flags) {
-    render_context = renderer;
-    screen_width = screen_width_;
-    screen_height = screen_height_;
-    global_flags = flags;
+void SL_FontSetKerning(SL_Font* font, int enabled) {
+    if (!font) return;
+    enabled = enabled && font->kerning_keys != NULL;
+    if (enabled == font->kerning_enabled) return;
+    font->kerning_enabled = enabled;
+    // Every text laid out with this font needs redoing
+    font->generation++;
+}
 
-    if ((flags & SL_FLAGS_MANAGE_MEMORY) == SL_FLAGS_MANAGE_MEMORY) {
+static void fontsQuit(void) {
+    for (int i = 0; i < fontCount; i++) {
+        if (Fonts[i]) {
+            releaseFont(Fonts[i]);
+            free(Fonts[i]);
+        }
+    }
+    free(Fonts);
+    Fonts = NULL;
+    fontCount = 0;
+    fontLimit = 0;
+    nameIndexFree(&FontMap);
+}
 
-        ElementHashMap = calloc(MAP_INIT, sizeof(SL_UIElement));
+// Atlases
 
-        mapCount = 0;
-        mapLimit = MAP_INIT;
+SL_Atlas* SL_CreateAtlas(int page_width, int page_height) {
+    if (page_width <= 0 || page_height <= 0) {
+        SDL_SetError("Bad atlas page size %dx%d", page_width, page_height);
+        return NULL;
     }
+    SL_Atlas* atlas = slCalloc(1, sizeof(SL_Atlas));
+    atlas->page_w = page_width;
+    atlas->page_h = page_height;
+    return atlas;
 }
 
-
-void SL_Quit() {
-    if ((global_flags & SL_FLAGS_MANAGE_MEMORY) == SL_FLAGS_MANAGE_MEMORY) {
-        free(ElementHashMap);
+static SL_AtlasEntry* atlasAdd(SL_Atlas* atlas, SDL_Surface* surface) {
+    if (!atlas || !surface) {
+        SDL_SetError("Nothing to add to the atlas");
+        return NULL;
     }
-    if (Glyphs != NULL) {
-        free(Glyphs);
+    if (atlas->built) {
+        SDL_SetError("Atlas is already built");
+        return NULL;
     }
+    if (atlas->count == atlas->limit) {
+        atlas->limit = atlas->limit ? atlas->limit * 2 : ATLAS_INIT;
+        atlas->entries = slRealloc(atlas->entries, atlas->limit * sizeof(SL_AtlasEntry));
+    }
+    SL_AtlasEntry* entry = &atlas->entries[atlas->count++];
+    entry->name = SL_NO_ID;
+    entry->font = NULL;
+    entry->surface = surface;
+    entry->region = (SDL_Rect){0, 0, surface->w, surface->h};
+    entry->page = -1;
+    return entry;
 }
 
-/**
- * 
- * @param
- * @return 
- */
-SL_UIElement* SL_CreateElement(SL_UIElementBuilder** builder_) {
-    const SL_UIElementBuilder builder = **builder_;
-
-    SL_UIElement* ptr;
-    if ((global_flags & SL_FLAGS_MANAGE_MEMORY) == SL_FLAGS_MANAGE_MEMORY) {
-        ptr = addItemToMap(ElementHashMap, builder.name, HASHMAP_TYPE_UI_ELEMENT, &mapCount, &mapLimit, NULL);
-    }
-    else {
-        ptr = malloc(sizeof(SL_UIElement));
+int SL_AtlasAddSkin(SL_Atlas* atlas, const char* name, SDL_Surface* surface) {
+    if (!name) {
+        SDL_SetError("Atlas skins need a name");
+        return -1;
     }
-    ptr->name = builder.name;
+    SL_AtlasEntry* entry = atlasAdd(atlas, surface);
+    if (!entry) return -1;
+    entry->name = SL_Intern(name);
+    return 0;
+}
 
-    if ((builder.flags & SL_INNERFLAG_ABSOLUTE) == SL_INNERFLAG_ABSOLUTE) {
-        ptr->src_rect.x = builder.xab;
-        ptr->src_rect.y = builder.yab;
-        ptr->src_rect.w = builder.wab;
-        ptr->src_rect.h = builder.hab;
+int SL_AtlasAddFont(SL_Atlas* atlas, SL_Font* font, SDL_Surface* page) {
+    if (!font) {
+        SDL_SetError("No font to add to the atlas");
+        return -1;
     }
-    else {
-        ptr->src_rect.x = (int)(builder.x * (float)screen_width);
-        ptr->src_rect.y = (int)(builder.y * (float)screen_height);
-        ptr->src_rect.w = (int)(builder.w * (float)screen_width);
-        ptr->src_rect.h = (int)(builder.h * (float)screen_height);
+    if (font->sdf) {
+        SDL_SetError("Distance field fonts draw from their own textures, they can't go in an atlas");
+        return -1;
     }
-    ptr->flags = builder.flags;
+    SL_AtlasEntry* entry = atlasAdd(atlas, page);
+    if (!entry) return -1;
+    SL_RetainFont(font);
+    entry->font = font;
+    return 0;
+}
 
-    if (builder.skin != NULL) {
-        // TODO error handle
-        ptr->texture_skin = builder.skin;
-        int tex_w;
-        int tex_h;
-        SDL_QueryTexture(builder.skin, NULL, NULL, &tex_w, &tex_h);
-        ptr->skin_step_x = tex_w / 3;
-        ptr->skin_step_y = tex_h / 3;
+// Lowest y a w x h rect can sit at with its left edge on node i, -1 if it would run off the page
+static int skylineFit(const SL_AtlasPage* page, int i, int w, int h, int page_w, int page_h) {
+    if (page->skyline[i].x + w > page_w) return -1;
+    int y = 0;
+    for (int left = w; left > 0 && i < page->nodes; i++) {
+        if (page->skyline[i].y > y) y = page->skyline[i].y;
+        left -= page->skyline[i].w;
     }
+    return y + h <= page_h ? y : -1;
+}
 
-    ptr->TextObjectMap = calloc(MAP_INIT, sizeof(SL_TextObject));
-    ptr->textMapCount = 0;
-    ptr->textMapLimit = MAP_INIT;
-    ptr->TextObjectIterator = calloc(MAX_TEXT_OBJS, sizeof(int));
-
-    for (int i = 0; i < builder.num_text_objects; i++) {
-        int idx;
-        SL_TextObject* obj_ptr = addItemToMap(ptr->TextObjectMap, builder.text_builders[i].id,
-                                              HASHMAP_TYPE_TEXT_ELEMENT, &ptr->textMapCount, &ptr->textMapLimit, &idx);
-        *obj_ptr = CreateTextObject(
-                builder.text_builders[i].text,
-                builder.text_builders[i].size,
-                builder.text_builders[i].x,
-                builder.text_builders[i].y
-        );
-        ptr->TextObjectIterator[ptr->textMapCount - 1] = idx;
-
+// Bottom-left: the spot that keeps the rect's bottom edge highest, narrowest node on ties
+static int skylinePack(SL_AtlasPage* page, int w, int h, int page_w, int page_h, SDL_Point* out) {
+    int best = -1;
+    int best_bottom = INT_MAX;
+    int best_w = INT_MAX;
+    for (int i = 0; i < page->nodes; i++) {
+        int y = skylineFit(page, i, w, h, page_w, page_h);
+        if (y < 0) continue;
+        if (y + h < best_bottom || (y + h == best_bottom && page->skyline[i].w < best_w)) {
+            best = i;
+            best_bottom = y + h;
+            best_w = page->skyline[i].w;
+        }
     }
+    if (best < 0) return -1;
 
-    ptr->font = builder.font;
-    SDL_SetTextureScaleMode(ptr->font, SDL_ScaleModeNearest);
-
-    free(builder.text_builders);
-    free(*builder_);
-
-    return ptr;
-}
+    if (page->nodes == page->node_limit) {
+        page->node_limit *= 2;
+        page->skyline = slRealloc(page->skyline, page->node_limit * sizeof(SL_SkylineNode));
+    }
+    SL_SkylineNode* sky = page->skyline;
+    out->x = sky[best].x;
+    out->y = best_bottom - h;
+    memmove(&sky[best + 1], &sky[best], (page->nodes - best) * sizeof(SL_SkylineNode));
+    sky[best] = (SL_SkylineNode){out->x, best_bottom, w};
+    page->nodes++;
 
-void SL_FreeElement(SL_UIElement* element) {
-    if (!element) return;
-    free(element->TextObjectMap);
-    free(element->TextObjectIterator);
-    if ((global_flags & SL_FLAGS_MANAGE_MEMORY) != SL_FLAGS_MANAGE_MEMORY) {
-        free(element);
+    // Trim whatever the new node now covers
+    for (int i = best + 1; i < page->nodes; i++) {
+        int overlap = sky[i - 1].x + sky[i - 1].w - sky[i].x;
+        if (overlap <= 0) break;
+        sky[i].x += overlap;
+        sky[i].w -= overlap;
+        if (sky[i].w > 0) break;
+        memmove(&sky[i], &sky[i + 1], (page->nodes - i - 1) * sizeof(SL_SkylineNode));
+        page->nodes--;
+        i--;
+    }
+    for (int i = 0; i + 1 < page->nodes;) {
+        if (sky[i].y == sky[i + 1].y) {
+            sky[i].w += sky[i + 1].w;
+            memmove(&sky[i + 1], &sky[i + 2], (page->nodes - i - 2) * sizeof(SL_SkylineNode));
+            page->nodes--;
+        }
+        else {
+            i++;
+        }
     }
+    return 0;
 }
 
-static SDL_Rect getGlyphSrc(char c) {
-    return Glyphs[c - font_start].src;
+static int compareEntryHeights(const void* a, const void* b) {
+    const SL_AtlasEntry* x = a;
+    const SL_AtlasEntry* y = b;
+    return y->region.h - x->region.h;
 }
 
-static SL_Glyph getGlyph(char c) {
-    return Glyphs[c - font_start];
+static void atlasAddPage(SL_Atlas* atlas) {
+    atlas->pages = slRealloc(atlas->pages, (atlas->page_count + 1) * sizeof(SL_AtlasPage));
+    SL_AtlasPage* page = &atlas->pages[atlas->page_count++];
+    page->texture = NULL;
+    page->node_limit = ATLAS_INIT;
+    page->skyline = slMalloc(page->node_limit * sizeof(SL_SkylineNode));
+    page->skyline[0] = (SL_SkylineNode){0, 0, atlas->page_w};
+    page->nodes = 1;
 }
 
-static int hashName(const char* name) {
-    unsigned long long hash = 0;
-    char* c = (char*) name;
-    while (*c != '\0') {
-        //hash += *c * 0x1F; // everybody loves mersenne primes!
-        hash += *c;
-        hash <<= 1;
-        c++;
+// Points the font's UVs at where its page landed. Binary fonts are mapped copy-on-write, only the UV table is rewritten
+// here so the mapped glyph pages are left alone
+static void remapFont(SL_Font* font, SDL_Texture* texture, SDL_Rect region, float page_w, float page_h) {
+    font->texture = texture;
+    font->atlas_region = region;
+    font->atlas_page_w = page_w;
+    font->atlas_page_h = page_h;
+    for (int i = 0; i < font->count; i++) {
+        const SDL_Rect* src = &font->glyphs[i].src;
+        float* uv = &font->table.uvs[i * 4];
+        uv[0] = (float)(region.x + src->x) / page_w;
+        uv[1] = (float)(region.x + src->x + src->w) / page_w;
+        uv[2] = (float)(region.y + src->y + src->h) / page_h;
+        uv[3] = (float)(region.y + src->y) / page_h;
     }
-    return ((int)(hash % UINT32_MAX)) % mapLimit;
+    font->generation++;
 }
 
-static void *getVoidPtrOffset(void *ptr, HashMapType type, int idx) {
-    void* addr = NULL;
-    switch (type) {
-        case HASHMAP_TYPE_UI_ELEMENT: {
-            SL_UIElement* temp = (SL_UIElement*) ptr;
-            addr = &(temp[idx]);
-            break;
-        }
-        case HASHMAP_TYPE_TEXT_ELEMENT: {
-            SL_TextObject* temp = (SL_TextObject*) ptr;
-            addr = &(temp[idx]);
-            break;
-        }
+static int atlasUploadPage(SL_Atlas* atlas, int p) {
+    SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, atlas->page_w, atlas->page_h, 32, SDL_PIXELFORMAT_RGBA32);
+    if (!surface) return -1;
+    for (int i = 0; i < atlas->count; i++) {
+        SL_AtlasEntry* entry = &atlas->entries[i];
+        if (entry->page != p) continue;
+        // Copy the pixels as they are, alpha included, instead of blending them onto the empty page
+        SDL_BlendMode mode;
+        SDL_GetSurfaceBlendMode(entry->surface, &mode);
+        SDL_SetSurfaceBlendMode(entry->surface, SDL_BLENDMODE_NONE);
+        SDL_Rect dst = entry->region;
+        SDL_BlitSurface(entry->surface, NULL, surface, &dst);
+        SDL_SetSurfaceBlendMode(entry->surface, mode);
     }
-    return addr;
+    SDL_Texture* texture = SDL_CreateTextureFromSurface(render_context, surface);
+    SDL_FreeSurface(surface);
+    if (!texture) return -1;
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+    SDL_SetTextureScaleMode(texture, SDL_ScaleModeNearest);
+    atlas->pages[p].texture = texture;
+    return 0;
 }
 
-// Takes in a name of an element to be created and returns the memory address to store it at
-static void *addItemToMap(void *map_, const char *name, HashMapType type, int *count, int *limit, int *index) {
-    int idx = hashName(name);
+int SL_BuildAtlas(SL_Atlas* atlas) {
+    if (!atlas || atlas->built) {
+        SDL_SetError("Atlas is already built");
+        return -1;
+    }
+    qsort(atlas->entries, atlas->count, sizeof(SL_AtlasEntry), compareEntryHeights);
 
-    while (itemAtAddressExists(getVoidPtrOffset(map_, type, idx))) {
-        idx = (idx + 1) % *limit;
+    for (int i = 0; i < atlas->count; i++) {
+        SL_AtlasEntry* entry = &atlas->entries[i];
+        int w = entry->region.w;
+        int h = entry->region.h;
+        if (w > atlas->page_w || h > atlas->page_h) {
+            SDL_SetError("%dx%d doesn't fit on a %dx%d atlas page", w, h, atlas->page_w, atlas->page_h);
+            return -1;
+        }
+        // Padding only where there's room for it, something exactly page sized still goes in
+        int pw = w + ATLAS_PADDING <= atlas->page_w ? w + ATLAS_PADDING : w;
+        int ph = h + ATLAS_PADDING <= atlas->page_h ? h + ATLAS_PADDING : h;
+        SDL_Point at;
+        int p;
+        for (p = 0; p < atlas->page_count; p++) {
+            if (skylinePack(&atlas->pages[p], pw, ph, atlas->page_w, atlas->page_h, &at) == 0) break;
+        }
+        if (p == atlas->page_count) {
+            atlasAddPage(atlas);
+            skylinePack(&atlas->pages[p], pw, ph, atlas->page_w, atlas->page_h, &at);
+        }
+        entry->page = p;
+        entry->region.x = at.x;
+        entry->region.y = at.y;
     }
-    void* ptr = getVoidPtrOffset(map_, type, idx);
-    if (index) {
-        *index = idx;
+
+    for (int p = 0; p < atlas->page_count; p++) {
+        if (atlasUploadPage(atlas, p) != 0) return -1;
     }
-    *count = *count + 1;
-    if (*count >= *limit) {
-        // TODO something about this is broken when the limit is reached...
-        // TODO also if i ever fix this we have to rehash
-        *limit *= 2;
-        size_t size = 0;
-        switch (type) {
-            case HASHMAP_TYPE_UI_ELEMENT: {
-                size = sizeof(SL_UIElement);
-                break;
-            }
-            case HASHMAP_TYPE_TEXT_ELEMENT: {
-                size = sizeof(SL_TextObject);
-                break;
-            }
+    for (int i = 0; i < atlas->count; i++) {
+        SL_AtlasEntry* entry = &atlas->entries[i];
+        entry->surface = NULL;
+        if (entry->font) {
+            remapFont(entry->font, atlas->pages[entry->page].texture, entry->region,
+                      (float)atlas->page_w, (float)atlas->page_h);
         }
-        void* temp1 = realloc(map_, *limit * size);
-        if (temp1 != NULL) *(&map_) = temp1;
     }
-    return ptr;
+    atlas->built = 1;
+    return 0;
 }
 
-SL_UIElement* getElementFromMap(const char* name) {
-    return (SL_UIElement*) getItemFromMap(ElementHashMap, name, &mapLimit, HASHMAP_TYPE_UI_ELEMENT);
+SDL_Texture* SL_AtlasGetSkin(const SL_Atlas* atlas, const char* name, SDL_Rect* region) {
+    if (!atlas || !atlas->built || !name) return NULL;
+    SL_Id id = findId(name);
+    for (int i = 0; id != SL_NO_ID && i < atlas->count; i++) {
+        const SL_AtlasEntry* entry = &atlas->entries[i];
+        if (entry->name != id) continue;
+        if (region) *region = entry->region;
+        return atlas->pages[entry->page].texture;
+    }
+    return NULL;
 }
 
-void *getItemFromMap(void *map_, const char *name, const int *limit, enum HashMapType type) {
-    int idx = hashName(name);
-
-    int start_idx = idx;
-    void* ptr = NULL;
-    do {
-
-        void* offset_ptr = getVoidPtrOffset(map_, type, idx);
-        int exists = itemAtAddressExists(offset_ptr);
-
-        const char* n_;
-
-        switch (type) {
-            case HASHMAP_TYPE_UI_ELEMENT: {
-                SL_UIElement* e = (SL_UIElement*) offset_ptr;
-                n_ = e->name;
-                break;
-            }
-            case HASHMAP_TYPE_TEXT_ELEMENT: {
-                SL_TextObject* obj = (SL_TextObject*) offset_ptr;
-                n_ = obj->id;
-                break;
-            }
-        }
+int SL_AtlasPageCount(const SL_Atlas* atlas) {
+    return atlas ? atlas->page_count : 0;
+}
 
-        if (exists && strcmp(name, n_) == 0) {
-            ptr = offset_ptr;
-            break;
+void SL_FreeAtlas(SL_Atlas* atlas) {
+    if (!atlas) return;
+    for (int i = 0; i < atlas->count; i++) {
+        SL_ReleaseFont(atlas->entries[i].font);
+    }
+    for (int p = 0; p < atlas->page_count; p++) {
+        if (atlas->pages[p].texture) {
+            SDL_DestroyTexture(atlas->pages[p].texture);
         }
-        idx = (idx + 1) % *limit;
-    } while (idx != start_idx);
-
-    return ptr;
+        free(atlas->pages[p].skyline);
+    }
+    free(atlas->pages);
+    free(atlas->entries);
+    free(atlas);
 }
 
-void SL_DrawElement(const SL_UIElement* element) {
+// Font loading
 
-    if (!SL_ElementIsActive(element)) return;
+// Picks the loader by looking at the file, not the extension
+static int loadFont(SL_Font* font, const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        SDL_SetError("Couldn't open font %s", path);
+        return -1;
+    }
+    char magic[4] = {0};
+    size_t read = fread(magic, 1, sizeof(magic), file);
+    fclose(file);
 
+    int result;
+    if (read == sizeof(magic) && memcmp(magic, FONT_FILE_MAGIC, sizeof(magic)) == 0) {
+        result = mapFontBinary(font, path);
+    }
+    else {
+        result = parseFontText(font, path);
+    }
+    if (result == 0) {
+        buildGlyphLookup(font);
+        buildKerningLookup(font);
+        buildGlyphTable(font);
+    }
+    return result;
+}
+
+static void buildGlyphLookup(SL_Font* font) {
+    memset(font->ascii, 0, sizeof(font->ascii));
+    font->page_index = NULL;
+    font->pages = NULL;
+    font->page_count = 0;
+
+    for (int i = 0; i < font->count; i++) {
+        uint32_t cp = font->glyphs[i].codepoint;
+        if (cp < 128) {
+            font->ascii[cp] = (uint16_t)(i + 1);
+            continue;
+        }
+        if (cp >= 0x110000 || i >= UINT16_MAX) {
+            continue;
+        }
+        if (!font->page_index) {
+            font->page_index = slCalloc(FONT_PAGE_COUNT, sizeof(uint16_t));
+        }
+        int page = font->page_index[cp >> FONT_PAGE_SHIFT];
+        if (!page) {
+            font->pages = slRealloc(font->pages, (font->page_count + 1) * (1 << FONT_PAGE_SHIFT) * sizeof(uint16_t));
+            memset(font->pages + font->page_count * (1 << FONT_PAGE_SHIFT), 0, (1 << FONT_PAGE_SHIFT) * sizeof(uint16_t));
+            page = ++font->page_count;
+            font->page_index[cp >> FONT_PAGE_SHIFT] = (uint16_t)page;
+        }
+        font->pages[(page - 1) * (1 << FONT_PAGE_SHIFT) + (cp & ((1 << FONT_PAGE_SHIFT) - 1))] = (uint16_t)(i + 1);
+    }
+
+    font->missing = -1;
+    int replacement = glyphIndex(font, UTF8_REPLACEMENT);
+    font->missing = replacement >= 0 ? replacement : glyphIndex(font, '?');
+}
+
+static void buildGlyphTable(SL_Font* font) {
+    // Text stores 16 bit indices, the blanks need the last two
+    if (font->count > UINT16_MAX - 1) {
+        font->count = UINT16_MAX - 1;
+    }
+    int n = font->count + 2;
+    SL_GlyphTable* table = &font->table;
+    table->boxes = slMalloc(n * 4 * sizeof(float));
+    table->uvs = slMalloc(n * 4 * sizeof(float));
+    table->codepoints = slMalloc(n * sizeof(uint32_t));
+    table->advances = slMalloc(n);
+    table->flags = slMalloc(n);
+    table->blank = font->count;
+
+    for (int i = 0; i < n; i++) {
+        static const SL_Glyph nothing;
+        const SL_Glyph* g = i < font->count ? &font->glyphs[i] : &nothing;
+        table->boxes[i * 4] = (float)g->x_offset;
+        table->boxes[i * 4 + 1] = (float)(g->src.w + g->x_offset);
+        table->boxes[i * 4 + 2] = (float)g->y_offset;
+        table->boxes[i * 4 + 3] = (float)(g->src.h + g->y_offset);
+        table->uvs[i * 4] = g->u_min;
+        table->uvs[i * 4 + 1] = g->u_max;
+        table->uvs[i * 4 + 2] = g->v_min;
+        table->uvs[i * 4 + 3] = g->v_max;
+        table->codepoints[i] = g->codepoint;
+        table->advances[i] = g->x_advance;
+        table->flags[i] = g->flags;
+    }
+    table->codepoints[table->blank + 1] = ' ';
+}
+
+// Like glyphIndex, but always something a text object can point at
+static uint16_t glyphSlot(const SL_Font* font, uint32_t codepoint) {
+    int idx = glyphIndex(font, codepoint);
+    if (idx >= 0) return (uint16_t)idx;
+    // Spaces still have to break words even when the font can't draw them
+    return (uint16_t)(font->table.blank + (codepoint == ' '));
+}
+
+static uint32_t kerningSlot(uint64_t key, int mask) {
+    return (uint32_t)((key * 0x9E3779B97F4A7C15ull) >> 32) & (uint32_t)mask;
+}
+
+static void buildKerningLookup(SL_Font* font) {
+    font->kerning_keys = NULL;
+    font->kerning_amounts = NULL;
+    font->kerning_mask = 0;
+    font->kerning_enabled = 0;
+    for (int i = 0; i < font->count; i++) {
+        font->glyphs[i].flags &= ~SL_GLYPH_KERNS;
+    }
+    if (font->kerning_count == 0) return;
+
+    int limit = 1;
+    while ((float)limit * KERNING_MAX_LOAD < (float)font->kerning_count) limit <<= 1;
+    font->kerning_keys = slCalloc(limit, sizeof(uint64_t));
+    font->kerning_amounts = slCalloc(limit, sizeof(int16_t));
+    font->kerning_mask = limit - 1;
+
+    for (int i = 0; i < font->kerning_count; i++) {
+        SL_Kerning k = font->kernings[i];
+        int first = glyphIndex(font, (uint32_t)k.first);
+        // Pairs for glyphs the font doesn't have would never be looked up
+        if (k.amount == 0 || k.first <= 0 || k.second <= 0 || first < 0
+            || k.first >= 0x110000 || k.second >= 0x110000) {
+            continue;
+        }
+        uint64_t key = ((uint64_t)k.first << 21) | (uint64_t)k.second;
+        uint32_t slot = kerningSlot(key, font->kerning_mask);
+        while (font->kerning_keys[slot] && font->kerning_keys[slot] != key) {
+            slot = (slot + 1) & font->kerning_mask;
+        }
+        font->kerning_keys[slot] = key;
+        font->kerning_amounts[slot] = (int16_t)k.amount;
+        font->glyphs[first].flags |= SL_GLYPH_KERNS;
+        font->kerning_enabled = 1;
+    }
+}
+
+static int kerningAmount(const SL_Font* font, uint32_t first, uint32_t second) {
+    uint64_t key = ((uint64_t)first << 21) | (uint64_t)second;
+    uint32_t slot = kerningSlot(key, font->kerning_mask);
+    while (font->kerning_keys[slot]) {
+        if (font->kerning_keys[slot] == key) {
+            return font->kerning_amounts[slot];
+        }
+        slot = (slot + 1) & font->kerning_mask;
+    }
+    return 0;
+}
+
+// Returns -1 when the font has nothing to draw for the codepoint
+static int glyphIndex(const SL_Font* font, uint32_t codepoint) {
+    int idx = 0;
+    if (codepoint < 128) {
+        idx = font->ascii[codepoint];
+    }
+    else if (font->page_index && codepoint < 0x110000) {
+        int page = font->page_index[codepoint >> FONT_PAGE_SHIFT];
+        if (page) {
+            idx = font->pages[(page - 1) * (1 << FONT_PAGE_SHIFT) + (codepoint & ((1 << FONT_PAGE_SHIFT) - 1))];
+        }
+    }
+    return idx ? idx - 1 : font->missing;
+}
+
+static void releaseFont(SL_Font* font) {
+    free(font->table.boxes);
+    free(font->table.uvs);
+    free(font->table.codepoints);
+    free(font->table.advances);
+    free(font->table.flags);
+    free(font->page_index);
+    free(font->pages);
+    free(font->kerning_keys);
+    free(font->kerning_amounts);
+    free(font->sdf);
+    for (int i = 0; i < font->sdf_size_count; i++) {
+        sdfFreeSize(&font->sdf_sizes[i]);
+    }
+    free(font->sdf_sizes);
+    if (font->mapping) {
+#ifndef _WIN32
+        munmap(font->mapping, font->mapping_size);
+#else
+        free(font->mapping);
+#endif
+    }
+    else {
+        free(font->glyphs);
+        free(font->kernings);
+    }
+    memset(font, 0, sizeof(SL_Font));
+}
+
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "cert-err34-c"
+#pragma ide diagnostic ignored "cppcoreguidelines-narrowing-conversions"
+// AngelCode BMFont text format
+static int parseFontText(SL_Font* font, const char* path) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        SDL_SetError("Couldn't open font %s", path);
+        return -1;
+    }
+    memset(font, 0, sizeof(SL_Font));
+    int kerning_limit = 0;
+    int glyph_limit = 0;
+    int result = 0;
+
+    char* str = slMalloc(128);
+    char* save = NULL; // strtok_r, hot reload parses fonts off the main thread
+
+    while (fgets(str, 128, file)) {
+        // printf("%s\n", str);
+        char* c = strtok_r(str, " ", &save);
+        if (!c) continue;
+        if (strcmp(c, "chars") == 0) {
+            c = strtok_r(NULL, " ", &save);
+            c = strtok_r(c, "=", &save);
+            c = c ? strtok_r(NULL, "=", &save) : NULL;
+            // A count missing or given twice is a broken file, not something to guess around
+            if (!c || (glyph_limit = atoi(c)) < 0 || font->glyphs) {
+                result = -1;
+                break;
+            }
+            // printf("Font count: %d\n", font_count);
+            font->glyphs = slCalloc(glyph_limit, sizeof(SL_Glyph));
+            continue;
+        }
+        else if (strcmp(c, "kernings") == 0) {
+            c = strtok_r(NULL, " ", &save);
+            c = strtok_r(c, "=", &save);
+            c = c ? strtok_r(NULL, "=", &save) : NULL;
+            if (!c || (kerning_limit = atoi(c)) < 0 || font->kernings) {
+                result = -1;
+                break;
+            }
+            font->kernings = slCalloc(kerning_limit, sizeof(SL_Kerning));
+            continue;
+        }
+        else if (strcmp(c, "info") == 0) {
+            c = strtok_r(NULL, " =", &save);
+            do {
+                // THIS BREAKS IF THE FONT NAME HAS A SPACE
+                char* key = c;
+                char* val = strtok_r(NULL, " =", &save);
+                if (!key || !val) break;
+                if (strcmp(key, "size") == 0) {
+                    font->size = atof(val);
+                }
+            } while ((c = strtok_r(NULL, " =", &save)));
+        }
+        else if (strcmp(c, "common") == 0) {
+            c = strtok_r(NULL, " =", &save);
+            do {
+                char* key = c;
+                char* val = strtok_r(NULL, " =", &save);
+                if (!key || !val) break;
+                if (strcmp(key, "scaleW") == 0) {
+                    font->tex_width = atof(val);
+                }
+                else if (strcmp(key, "scaleH") == 0) {
+                    font->tex_height = atof(val);
+                }
+                else if (strcmp(key, "lineHeight") == 0) {
+                    font->line_height = atoi(val);
+                }
+                else if (strcmp(key, "base") == 0) {
+                    font->base = atoi(val);
+                }
+            } while ((c = strtok_r(NULL, " =", &save)));
+        }
+        // Same as msdf-bmfont writes it
+        else if (strcmp(c, "distanceField") == 0) {
+            c = strtok_r(NULL, " =", &save);
+            do {
+                char* key = c;
+                char* val = strtok_r(NULL, " =", &save);
+                if (!key || !val) break;
+                if (strcmp(key, "fieldType") == 0) {
+                    font->sdf_multi = strncmp(val, "msdf", 4) == 0 || strncmp(val, "mtsdf", 5) == 0;
+                }
+                else if (strcmp(key, "distanceRange") == 0) {
+                    font->sdf_range = atof(val);
+                }
+            } while ((c = strtok_r(NULL, " =", &save)));
+        }
+        else if (strcmp(c, "char") == 0) {
+            int id = 0;
+            int x = 0;
+            int y = 0;
+            int w = 0;
+            int h = 0;
+            char xoff = 0;
+            char yoff = 0;
+            unsigned char xadv = 0;
+
+            c = strtok_r(NULL, " =", &save);
+            do {
+                char* key = c;
+                char* val = strtok_r(NULL, " =", &save);
+                // printf("Key: %s Val: %s\n", key, val);
+                if (!key || !val) break;
+                if (strcmp(key, "id") == 0) {
+                    id = atoi(val);
+                }
+                else if (strcmp(key, "x") == 0) {
+                    x = atoi(val);
+                }
+                else if (strcmp(key, "y") == 0) {
+                    y = atoi(val);
+                }
+                else if (strcmp(key, "width") == 0) {
+                    w = atoi(val);
+                }
+                else if (strcmp(key, "height") == 0) {
+                    h = atoi(val);
+                }
+                else if (strcmp(key, "xoffset") == 0) {
+                    xoff = atoi(val);
+                }
+                else if (strcmp(key, "yoffset") == 0) {
+                    yoff = atoi(val);
+                }
+                else if (strcmp(key, "xadvance") == 0) {
+                    xadv = atoi(val);
+                }
+            } while ((c = strtok_r(NULL, " =", &save)));
+            if (id < 0 || font->count >= glyph_limit) {
+                continue;
+            }
+            SDL_Rect r = {x, y, w, h};
+            SL_Glyph g = {.src = r, .x_offset = xoff, .y_offset = yoff, .x_advance = xadv, .flags = 0};
+
+            // TODO test UV
+            g.u_min = (float)x / font->tex_width;
+            g.u_max = (float)(x + w) / font->tex_width;
+            g.v_min = (float)(y + h) / font->tex_height;
+            g.v_max = (float)y / font->tex_height;
+            g.codepoint = (uint32_t)id;
+            font->glyphs[font->count++] = g;
+        }
+        else if (strcmp(c, "kerning") == 0) {
+            SL_Kerning k = {0, 0, 0};
+            c = strtok_r(NULL, " =", &save);
+            do {
+                char* key = c;
+                char* val = strtok_r(NULL, " =", &save);
+                if (!key || !val) break;
+                if (strcmp(key, "first") == 0) {
+                    k.first = atoi(val);
+                }
+                else if (strcmp(key, "second") == 0) {
+                    k.second = atoi(val);
+                }
+                else if (strcmp(key, "amount") == 0) {
+                    k.amount = atoi(val);
+                }
+            } while ((c = strtok_r(NULL, " =", &save)));
+            if (font->kerning_count < kerning_limit) {
+                font->kernings[font->kerning_count++] = k;
+            }
+        }
+    }
+
+    free(str);
+    fclose(file);
+    if (result != 0) {
+        SDL_SetError("Font %s is malformed", path);
+        releaseFont(font);
+    }
+    return result;
+}
+#pragma clang diagnostic pop
+
+// Precompiled binary font - the tables are used in place, nothing is parsed or copied
+static int mapFontBinary(SL_Font* font, const char* path) {
+    memset(font, 0, sizeof(SL_Font));
+    size_t size;
+    void* data;
+#ifndef _WIN32
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        SDL_SetError("Couldn't open font %s", path);
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(SL_FontFileHeader)) {
+        close(fd);
+        SDL_SetError("Bad binary font %s", path);
+        return -1;
+    }
+    size = (size_t)st.st_size;
+    // Private + writable so the tables can be patched in place (copy on write) without touching the file
+    data = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        SDL_SetError("Couldn't map font %s", path);
+        return -1;
+    }
+#else
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        SDL_SetError("Couldn't open font %s", path);
+        return -1;
+    }
+    fseek(file, 0, SEEK_END);
+    size = (size_t)ftell(file);
+    fseek(file, 0, SEEK_SET);
+    data = slMalloc(size);
+    if (!data || fread(data, 1, size, file) != size) {
+        free(data);
+        fclose(file);
+        SDL_SetError("Couldn't read font %s", path);
+        return -1;
+    }
+    fclose(file);
+#endif
+    font->mapping = data;
+    font->mapping_size = size;
+
+    const SL_FontFileHeader* header = data;
+    if (size < sizeof(SL_FontFileHeader)
+        || header->version != FONT_FILE_VERSION
+        || header->glyph_size != sizeof(SL_Glyph)
+        || header->glyph_offset + (size_t)header->glyph_count * sizeof(SL_Glyph) > size
+        || header->kerning_offset + (size_t)header->kerning_count * sizeof(SL_Kerning) > size) {
+        releaseFont(font);
+        SDL_SetError("Bad binary font %s", path);
+        return -1;
+    }
+
+    font->glyphs = (SL_Glyph*)((char*)data + header->glyph_offset);
+    font->kernings = (SL_Kerning*)((char*)data + header->kerning_offset);
+    font->count = (int)header->glyph_count;
+    font->kerning_count = (int)header->kerning_count;
+    font->size = header->size;
+    font->tex_width = header->tex_width;
+    font->tex_height = header->tex_height;
+    font->line_height = header->line_height;
+    font->base = header->base;
+    font->sdf_range = header->sdf_range;
+    font->sdf_multi = header->sdf_multi;
+    return 0;
+}
+
+/*
+ * Output files are written next to their target and renamed over it. A running game may have the old file mapped,
+ * and truncating it under the mapping would fault. This way anything mapped keeps the old pages, and the hot
+ * reloader only ever sees a complete file arrive. tmp_path needs room for the path plus ".tmp"
+ */
+static int replacementPath(const char* path, char* tmp_path, size_t tmp_size) {
+    if ((size_t)snprintf(tmp_path, tmp_size, "%s.tmp", path) >= tmp_size) {
+        SDL_SetError("Path too long: %s", path);
+        return -1;
+    }
+    return 0;
+}
+
+static FILE* openReplacement(const char* path, const char* mode, char* tmp_path, size_t tmp_size) {
+    if (replacementPath(path, tmp_path, tmp_size) != 0) {
+        return NULL;
+    }
+    FILE* file = fopen(tmp_path, mode);
+    if (!file) {
+        SDL_SetError("Couldn't open %s for writing", tmp_path);
+    }
+    return file;
+}
+
+static int replaceFile(const char* tmp_path, const char* path) {
+#ifdef _WIN32
+    // No replacing rename here, but nothing's mapped on Windows either
+    remove(path);
+#endif
+    if (rename(tmp_path, path) != 0) {
+        SDL_SetError("Couldn't replace %s", path);
+        remove(tmp_path);
+        return -1;
+    }
+    return 0;
+}
+
+// Closes the temporary, throwing it away if anything went wrong writing it
+static int closeReplacement(FILE* file, int failed, const char* tmp_path) {
+    failed = failed || ferror(file);
+    if (fclose(file) != 0) failed = 1;
+    if (failed) {
+        SDL_SetError("Couldn't write %s", tmp_path);
+        remove(tmp_path);
+        return -1;
+    }
+    return 0;
+}
+
+static int commitReplacement(FILE* file, int failed, const char* tmp_path, const char* path) {
+    if (closeReplacement(file, failed, tmp_path) != 0) {
+        return -1;
+    }
+    return replaceFile(tmp_path, path);
+}
+
+int SL_CompileFont(const char* fnt_path, const char* out_path) {
+    SL_Font font;
+    if (parseFontText(&font, fnt_path) != 0) {
+        return -1;
+    }
+
+    SL_FontFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, FONT_FILE_MAGIC, sizeof(header.magic));
+    header.version = FONT_FILE_VERSION;
+    header.glyph_size = sizeof(SL_Glyph);
+    header.glyph_count = (uint32_t)font.count;
+    header.kerning_count = (uint32_t)font.kerning_count;
+    header.glyph_offset = sizeof(SL_FontFileHeader);
+    header.kerning_offset = header.glyph_offset + header.glyph_count * sizeof(SL_Glyph);
+    header.size = font.size;
+    header.tex_width = font.tex_width;
+    header.tex_height = font.tex_height;
+    header.line_height = font.line_height;
+    header.base = font.base;
+    header.sdf_range = font.sdf_range;
+    header.sdf_multi = font.sdf_multi;
+
+    char tmp_path[4096];
+    int result = -1;
+    FILE* file = openReplacement(out_path, "wb", tmp_path, sizeof(tmp_path));
+    if (file) {
+        int failed = fwrite(&header, sizeof(header), 1, file) != 1
+            || fwrite(font.glyphs, sizeof(SL_Glyph), font.count, file) != (size_t)font.count
+            || (font.kerning_count > 0
+                && fwrite(font.kernings, sizeof(SL_Kerning), font.kerning_count, file) != (size_t)font.kerning_count);
+        result = commitReplacement(file, failed, tmp_path, out_path);
+    }
+    releaseFont(&font);
+    return result;
+}
+
+// Distance field fonts
+
+SL_Font* SL_LoadSdfFont(SDL_Surface* atlas, const char* path) {
+    if (!atlas) {
+        SDL_SetError("No distance field atlas for %s", path ? path : "font");
+        return NULL;
+    }
+    SL_Font* font = SL_LoadFont(NULL, path);
+    if (!font) return NULL;
+    if (font->sdf_range <= 0) {
+        SL_ReleaseFont(font);
+        SDL_SetError("%s isn't a distance field font", path);
+        return NULL;
+    }
+    // Already loaded by path, the field's shared along with everything else
+    if (font->sdf) return font;
+
+    SDL_Surface* rgba = SDL_ConvertSurfaceFormat(atlas, SDL_PIXELFORMAT_RGBA32, 0);
+    if (!rgba) {
+        SL_ReleaseFont(font);
+        return NULL;
+    }
+    font->sdf_width = rgba->w;
+    font->sdf_height = rgba->h;
+    font->sdf = slMalloc((size_t)rgba->w * rgba->h);
+    SDL_LockSurface(rgba);
+    for (int y = 0; y < rgba->h; y++) {
+        const Uint8* p = (const Uint8*)rgba->pixels + y * rgba->pitch;
+        unsigned char* out = font->sdf + y * rgba->w;
+        for (int x = 0; x < rgba->w; x++, p += 4) {
+            if (font->sdf_multi) {
+                Uint8 lo = p[0] < p[1] ? p[0] : p[1];
+                Uint8 hi = p[0] < p[1] ? p[1] : p[0];
+                out[x] = p[2] < lo ? lo : (p[2] > hi ? hi : p[2]);
+            }
+            else {
+                // Some tools put the field in alpha over white, others in grey over opaque. The smaller one works for both
+                out[x] = p[3] < p[0] ? p[3] : p[0];
+            }
+        }
+    }
+    SDL_UnlockSurface(rgba);
+    SDL_FreeSurface(rgba);
+    return font;
+}
+
+// Bilinear, kept inside the glyph's own rect so neighbours on the atlas don't bleed in
+static float sdfSample(const SL_Font* font, const SDL_Rect* src, float x, float y) {
+    float min_x = (float)src->x + 0.5f, max_x = (float)(src->x + src->w) - 0.5f;
+    float min_y = (float)src->y + 0.5f, max_y = (float)(src->y + src->h) - 0.5f;
+    x = x < min_x ? min_x : (x > max_x ? max_x : x);
+    y = y < min_y ? min_y : (y > max_y ? max_y : y);
+    x -= 0.5f;
+    y -= 0.5f;
+    int x0 = (int)x, y0 = (int)y;
+    int x1 = x0 + 1 < font->sdf_width ? x0 + 1 : x0;
+    int y1 = y0 + 1 < font->sdf_height ? y0 + 1 : y0;
+    float fx = x - (float)x0, fy = y - (float)y0;
+    const unsigned char* row0 = font->sdf + y0 * font->sdf_width;
+    const unsigned char* row1 = font->sdf + y1 * font->sdf_width;
+    float top = row0[x0] + (row0[x1] - row0[x0]) * fx;
+    float bottom = row1[x0] + (row1[x1] - row1[x0]) * fx;
+    return (top + (bottom - top) * fy) / 255.0f;
+}
+
+/*
+ * Cuts a coverage texture for one size out of the field. Each output pixel is the distance at its centre, in
+ * output pixels, turned into coverage over a one pixel ramp - the usual SDF threshold, just done once up front.
+ */
+static int sdfRasterize(SL_Font* font, SL_SdfSize* size) {
+    float scale = (float)size->px / font->size;
+    int n = font->count + 2;
+    // Realloc'd every time, a reload can change the glyph count
+    size->uvs = slRealloc(size->uvs, n * 4 * sizeof(float));
+
+    // Shelves, one pixel apart. Positions go in the uvs until the page size is known
+    int page_w = SDF_PAGE_MIN_WIDTH;
+    for (int i = 0; i < font->count; i++) {
+        while ((int)ceilf((float)font->glyphs[i].src.w * scale) + 2 > page_w) page_w *= 2;
+    }
+    int x = 1, y = 1, row_h = 0;
+    for (int i = 0; i < n; i++) {
+        float* uv = &size->uvs[i * 4];
+        int w = i < font->count ? (int)ceilf((float)font->glyphs[i].src.w * scale) : 0;
+        int h = i < font->count ? (int)ceilf((float)font->glyphs[i].src.h * scale) : 0;
+        if (w == 0 || h == 0) {
+            uv[0] = uv[1] = uv[2] = uv[3] = -1;
+            continue;
+        }
+        if (x + w + 1 > page_w) {
+            x = 1;
+            y += row_h + 1;
+            row_h = 0;
+        }
+        uv[0] = (float)x;
+        uv[1] = (float)y;
+        x += w + 1;
+        if (h > row_h) row_h = h;
+    }
+    int page_h = y + row_h + 1;
+
+    SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, page_w, page_h, 32, SDL_PIXELFORMAT_RGBA32);
+    if (!surface) return -1;
+    SDL_LockSurface(surface);
+    memset(surface->pixels, 0, (size_t)surface->pitch * page_h);
+    float ramp = font->sdf_range * scale; // output pixels from 0 to 255 in the field
+    for (int i = 0; i < n; i++) {
+        float* uv = &size->uvs[i * 4];
+        if (uv[0] < 0) {
+            uv[0] = uv[1] = uv[2] = uv[3] = 0;
+            continue;
+        }
+        const SDL_Rect* src = &font->glyphs[i].src;
+        int gx = (int)uv[0], gy = (int)uv[1];
+        int w = (int)ceilf((float)src->w * scale);
+        int h = (int)ceilf((float)src->h * scale);
+        for (int py = 0; py < h; py++) {
+            Uint8* out = (Uint8*)surface->pixels + (gy + py) * surface->pitch + gx * 4;
+            float sy = (float)src->y + ((float)py + 0.5f) / scale;
+            for (int px = 0; px < w; px++, out += 4) {
+                float sx = (float)src->x + ((float)px + 0.5f) / scale;
+                float coverage = (sdfSample(font, src, sx, sy) - 0.5f) * ramp + 0.5f;
+                coverage = coverage < 0 ? 0 : (coverage > 1 ? 1 : coverage);
+                out[0] = out[1] = out[2] = 255;
+                out[3] = (Uint8)(coverage * 255.0f + 0.5f);
+            }
+        }
+        // Same orientation as the glyph table, v_min at the bottom
+        uv[0] = (float)gx / (float)page_w;
+        uv[1] = ((float)gx + (float)src->w * scale) / (float)page_w;
+        uv[3] = (float)gy / (float)page_h;
+        uv[2] = ((float)gy + (float)src->h * scale) / (float)page_h;
+    }
+    SDL_UnlockSurface(surface);
+
+    SDL_Texture* texture = SDL_CreateTextureFromSurface(render_context, surface);
+    SDL_FreeSurface(surface);
+    if (!texture) return -1;
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+    SDL_SetTextureScaleMode(texture, SDL_ScaleModeNearest);
+    if (size->texture) {
+        SDL_DestroyTexture(size->texture);
+    }
+    size->texture = texture;
+    size->width = page_w;
+    size->height = page_h;
+    return 0;
+}
+
+static void sdfFreeSize(SL_SdfSize* size) {
+    if (size->texture) {
+        SDL_DestroyTexture(size->texture);
+    }
+    free(size->uvs);
+    memset(size, 0, sizeof(SL_SdfSize));
+}
+
+// Index of the size for text at this scale, rasterised if nothing's using it yet. -1 if it couldn't be
+static int sdfAcquire(SL_Font* font, float scale) {
+    static Uint32 tick = 0;
+    int px = (int)(scale * font->size + 0.5f);
+    if (px < 1) px = 1;
+
+    int free_slot = -1;
+    int oldest = -1;
+    for (int i = 0; i < font->sdf_size_count; i++) {
+        SL_SdfSize* size = &font->sdf_sizes[i];
+        if (size->px == px) {
+            size->refs++;
+            size->last_used = ++tick;
+            return i;
+        }
+        if (size->px == 0) {
+            free_slot = i;
+        }
+        else if (size->refs == 0 && (oldest < 0 || size->last_used < font->sdf_sizes[oldest].last_used)) {
+            oldest = i;
+        }
+    }
+
+    int idx = free_slot;
+    if (idx < 0 && oldest >= 0 && font->sdf_size_count >= SDF_SIZE_CACHE) {
+        sdfFreeSize(&font->sdf_sizes[oldest]);
+        idx = oldest;
+    }
+    if (idx < 0) {
+        font->sdf_sizes = slRealloc(font->sdf_sizes, (font->sdf_size_count + 1) * sizeof(SL_SdfSize));
+        idx = font->sdf_size_count++;
+        memset(&font->sdf_sizes[idx], 0, sizeof(SL_SdfSize));
+    }
+    SL_SdfSize* size = &font->sdf_sizes[idx];
+    size->px = px;
+    if (sdfRasterize(font, size) != 0) {
+        SDL_Log("Sliggy: couldn't rasterise %s at %dpx: %s", intern_names[font->path], px, SDL_GetError());
+        sdfFreeSize(size);
+        return -1;
+    }
+    size->refs = 1;
+    size->last_used = ++tick;
+    return idx;
+}
+
+static void sdfRelease(SL_Font* font, int idx) {
+    if (font && idx >= 0 && idx < font->sdf_size_count && font->sdf_sizes[idx].refs > 0) {
+        font->sdf_sizes[idx].refs--;
+    }
+}
+
+// The glyphs moved under the field (hot reload), redo every size something is using and drop the rest
+static void sdfRefresh(SL_Font* font) {
+    for (int i = 0; i < font->sdf_size_count; i++) {
+        SL_SdfSize* size = &font->sdf_sizes[i];
+        if (size->refs == 0) {
+            sdfFreeSize(size);
+        }
+        else if (sdfRasterize(font, size) != 0) {
+            SDL_Log("Sliggy: couldn't rasterise %s at %dpx: %s", intern_names[font->path], size->px, SDL_GetError());
+        }
+    }
+}
+
+/*
+ * One dimensional squared distance transform (Felzenszwalb & Huttenlocher), f is replaced with the distances.
+ * v and z are scratch, n and n + 1 long.
+ */
+static void edt1d(float* f, int n, float* d, int* v, float* z) {
+    int k = 0;
+    v[0] = 0;
+    z[0] = -INFINITY;
+    z[1] = INFINITY;
+    for (int q = 1; q < n; q++) {
+        float s = ((f[q] + (float)(q * q)) - (f[v[k]] + (float)(v[k] * v[k]))) / (float)(2 * q - 2 * v[k]);
+        while (s <= z[k]) {
+            k--;
+            s = ((f[q] + (float)(q * q)) - (f[v[k]] + (float)(v[k] * v[k]))) / (float)(2 * q - 2 * v[k]);
+        }
+        k++;
+        v[k] = q;
+        z[k] = s;
+        z[k + 1] = INFINITY;
+    }
+    k = 0;
+    for (int q = 0; q < n; q++) {
+        while (z[k + 1] < (float)q) k++;
+        d[q] = (float)((q - v[k]) * (q - v[k])) + f[v[k]];
+    }
+    memcpy(f, d, n * sizeof(float));
+}
+
+// Squared distance from every cell to the nearest cell where grid is set, over columns then rows
+static void edt2d(float* grid, int w, int h, float* scratch, int* v) {
+    float* column = scratch;
+    float* d = scratch + (w > h ? w : h);
+    float* z = d + (w > h ? w : h);
+    for (int x = 0; x < w; x++) {
+        for (int y = 0; y < h; y++) column[y] = grid[y * w + x];
+        edt1d(column, h, d, v, z);
+        for (int y = 0; y < h; y++) grid[y * w + x] = column[y];
+    }
+    for (int y = 0; y < h; y++) {
+        edt1d(grid + y * w, w, d, v, z);
+    }
+}
+
+SDL_Surface* SL_GenerateSdfFont(const char* fnt_path, SDL_Surface* page, int spread, const char* out_fnt,
+                                const char* out_page, SL_SurfaceSaver saver, void* userdata) {
+    if (!page || spread <= 0 || !out_fnt || !out_page) {
+        SDL_SetError("Need a page, a spread above 0 and somewhere to write to");
+        return NULL;
+    }
+    // The .fnt points at the page by name, relative to itself
+    const char* page_file = strrchr(out_page, '/');
+    page_file = page_file ? page_file + 1 : out_page;
+    SL_Font font;
+    if (parseFontText(&font, fnt_path) != 0) {
+        return NULL;
+    }
+    if (font.sdf_range > 0) {
+        releaseFont(&font);
+        SDL_SetError("%s is already a distance field font", fnt_path);
+        return NULL;
+    }
+    if (font.count <= 0) {
+        releaseFont(&font);
+        SDL_SetError("%s has no glyphs to make a field for", fnt_path);
+        return NULL;
+    }
+    SDL_Surface* rgba = SDL_ConvertSurfaceFormat(page, SDL_PIXELFORMAT_RGBA32, 0);
+    if (!rgba) {
+        releaseFont(&font);
+        return NULL;
+    }
+    // Coverage is alpha, or brightness for pages without any
+    int channel = page->format->Amask ? 3 : 0;
+
+    // Every glyph grows by spread on each side, packed on shelves at the original page width or wider
+    int page_w = (int)font.tex_width > 0 ? (int)font.tex_width : SDF_PAGE_MIN_WIDTH;
+    int cell_max = 0;
+    for (int i = 0; i < font.count; i++) {
+        const SDL_Rect* src = &font.glyphs[i].src;
+        int w = src->w + 2 * spread, h = src->h + 2 * spread;
+        while (w + 2 > page_w) page_w *= 2;
+        if (w > cell_max) cell_max = w;
+        if (h > cell_max) cell_max = h;
+    }
+    SDL_Point* at = slMalloc((size_t)font.count * sizeof(SDL_Point));
+    int x = 1, y = 1, row_h = 0;
+    for (int i = 0; i < font.count; i++) {
+        const SDL_Rect* src = &font.glyphs[i].src;
+        if (src->w == 0 || src->h == 0) {
+            at[i] = (SDL_Point){0, 0};
+            continue;
+        }
+        int w = src->w + 2 * spread, h = src->h + 2 * spread;
+        if (x + w + 1 > page_w) {
+            x = 1;
+            y += row_h + 1;
+            row_h = 0;
+        }
+        at[i] = (SDL_Point){x, y};
+        x += w + 1;
+        if (h > row_h) row_h = h;
+    }
+    int page_h = y + row_h + 1;
+
+    SDL_Surface* out = SDL_CreateRGBSurfaceWithFormat(0, page_w, page_h, 32, SDL_PIXELFORMAT_RGBA32);
+    if (!out) {
+        free(at);
+        SDL_FreeSurface(rgba);
+        releaseFont(&font);
+        return NULL;
+    }
+    SDL_LockSurface(out);
+    memset(out->pixels, 0, (size_t)out->pitch * page_h);
+    SDL_LockSurface(rgba);
+
+    size_t cells = (size_t)cell_max * cell_max;
+    float* inside = slMalloc(cells * sizeof(float));
+    float* outside = slMalloc(cells * sizeof(float));
+    float* scratch = slMalloc((3 * cell_max + 1) * sizeof(float));
+    int* v = slMalloc(cell_max * sizeof(int));
+    float range = (float)(2 * spread);
+
+    for (int i = 0; i < font.count; i++) {
+        const SDL_Rect* src = &font.glyphs[i].src;
+        if (src->w == 0 || src->h == 0) continue;
+        int w = src->w + 2 * spread, h = src->h + 2 * spread;
+        // Distances to the nearest inside pixel and to the nearest outside one
+        for (int cy = 0; cy < h; cy++) {
+            for (int cx = 0; cx < w; cx++) {
+                int sx = src->x + cx - spread, sy = src->y + cy - spread;
+                int in = 0;
+                if (cx >= spread && cx < spread + src->w && cy >= spread && cy < spread + src->h
+                    && sx >= 0 && sy >= 0 && sx < rgba->w && sy < rgba->h) {
+                    in = ((const Uint8*)rgba->pixels)[sy * rgba->pitch + sx * 4 + channel] >= 128;
+                }
+                inside[cy * w + cx] = in ? 0 : SDF_FAR;
+                outside[cy * w + cx] = in ? SDF_FAR : 0;
+            }
+        }
+        edt2d(inside, w, h, scratch, v);
+        edt2d(outside, w, h, scratch, v);
+        for (int cy = 0; cy < h; cy++) {
+            Uint8* p = (Uint8*)out->pixels + (at[i].y + cy) * out->pitch + at[i].x * 4;
+            for (int cx = 0; cx < w; cx++, p += 4) {
+                // Edges sit half way between an inside pixel and an outside one
+                float in = inside[cy * w + cx], outd = outside[cy * w + cx];
+                float dist = in == 0 ? sqrtf(outd) - 0.5f : 0.5f - sqrtf(in);
+                float value = 0.5f + dist / range;
+                value = value < 0 ? 0 : (value > 1 ? 1 : value);
+                p[0] = p[1] = p[2] = p[3] = (Uint8)(value * 255.0f + 0.5f);
+            }
+        }
+    }
+    free(inside);
+    free(outside);
+    free(scratch);
+    free(v);
+    SDL_UnlockSurface(rgba);
+    SDL_UnlockSurface(out);
+    SDL_FreeSurface(rgba);
+
+    char tmp_path[4096];
+    FILE* file = openReplacement(out_fnt, "w", tmp_path, sizeof(tmp_path));
+    if (!file) {
+        free(at);
+        SDL_FreeSurface(out);
+        releaseFont(&font);
+        return NULL;
+    }
+    // Kept short, the parser reads lines into a fixed buffer
+    fprintf(file, "info size=%d padding=%d,%d,%d,%d\n", (int)font.size, spread, spread, spread, spread);
+    fprintf(file, "common lineHeight=%d base=%d scaleW=%d scaleH=%d pages=1\n", font.line_height, font.base, page_w, page_h);
+    fprintf(file, "page id=0 file=\"%s\"\n", page_file);
+    fprintf(file, "distanceField fieldType=sdf distanceRange=%d\n", 2 * spread);
+    fprintf(file, "chars count=%d\n", font.count);
+    for (int i = 0; i < font.count; i++) {
+        const SL_Glyph* g = &font.glyphs[i];
+        int empty = g->src.w == 0 || g->src.h == 0;
+        int pad = empty ? 0 : spread;
+        int x_offset = g->x_offset - pad, y_offset = g->y_offset - pad;
+        // Offsets are stored in a byte
+        x_offset = x_offset < -128 ? -128 : x_offset;
+        y_offset = y_offset < -128 ? -128 : y_offset;
+        fprintf(file, "char id=%u x=%d y=%d width=%d height=%d xoffset=%d yoffset=%d xadvance=%d\n",
+                (unsigned)g->codepoint, at[i].x, at[i].y, empty ? 0 : g->src.w + 2 * pad, empty ? 0 : g->src.h + 2 * pad,
+                x_offset, y_offset, g->x_advance);
+    }
+    if (font.kerning_count > 0) {
+        fprintf(file, "kernings count=%d\n", font.kerning_count);
+        for (int i = 0; i < font.kerning_count; i++) {
+            fprintf(file, "kerning first=%d second=%d amount=%d\n", (int)font.kernings[i].first,
+                    (int)font.kernings[i].second, (int)font.kernings[i].amount);
+        }
+    }
+    free(at);
+    releaseFont(&font);
+    if (closeReplacement(file, 0, tmp_path) != 0) {
+        SDL_FreeSurface(out);
+        return NULL;
+    }
+
+    // The atlas goes into place first, so anything that sees the new .fnt finds the page it was made for
+    char page_tmp[4096];
+    int result = replacementPath(out_page, page_tmp, sizeof(page_tmp));
+    if (result == 0) {
+        result = saver ? saver(out, page_tmp, userdata) : SDL_SaveBMP(out, page_tmp);
+        if (result != 0) {
+            remove(page_tmp);
+        }
+    }
+    if (result == 0) {
+        result = replaceFile(page_tmp, out_page);
+    }
+    if (result == 0) {
+        result = replaceFile(tmp_path, out_fnt);
+    }
+    if (result != 0) {
+        remove(tmp_path);
+        SDL_FreeSurface(out);
+        return NULL;
+    }
+    return out;
+}
+
+// Core / element definitions
+
+void SL_Init(SDL_Renderer* renderer, int screen_width_, int screen_height_, int flags) {
+    render_context = renderer;
+    screen_width = screen_width_;
+    screen_height = screen_height_;
+    global_flags = flags;
+
+    elementCount = 0;
+    elementFreeList = -1;
+    elementFreeCount = 0;
+}
+
+
+void SL_Quit() {
+    // Unmanaged elements live in the same pages, any still around go too
+    for (int i = 0; i < elementCount; i++) {
+        SL_FreeElement(elementAt(i));
+        releaseElementSlot(elementAt(i));
+    }
+    for (int i = 0; i < elementPageCount; i++) {
+        free(ElementPages[i]);
+    }
+    free(ElementPages);
+    ElementPages = NULL;
+    elementPageCount = 0;
+    elementCount = 0;
+    elementFreeList = -1;
+    elementFreeCount = 0;
+    free(ElementById);
+    ElementById = NULL;
+    elementByIdLimit = 0;
+    free(DrawOrder);
+    DrawOrder = NULL;
+    drawOrderCount = 0;
+    drawOrderLimit = 0;
+    drawOrderHoles = 0;
+    SL_SetRetained(0);
+    SL_SetJobThreads(1);
+    free(job_elements);
+    job_elements = NULL;
+    job_element_limit = 0;
+    SL_DisableHotReload();
+    sourcesQuit();
+    shapeCacheQuit();
+    fontsQuit();
+    internQuit();
+    frameArenaFree();
+    frame_arena_high_water = 0;
+}
+
+/**
+ * 
+ * @param
+ * @return 
+ */
+SL_UIElement* SL_CreateElement(SL_UIElementBuilder** builder_) {
+    SL_UIElement* ptr = createElement(*builder_);
+    free((*builder_)->text_builders);
+    free(*builder_);
+    return ptr;
+}
+
+// Takes over the builder's font references but leaves its memory alone, blueprints build on the stack
+static SL_UIElement* createElement(const SL_UIElementBuilder* builder_) {
+    const SL_UIElementBuilder builder = *builder_;
+
+    SL_UIElement* ptr = allocElement();
+    // A name that's already taken now points at the newer element
+    if ((global_flags & SL_FLAGS_MANAGE_MEMORY) == SL_FLAGS_MANAGE_MEMORY && builder.name != SL_NO_ID) {
+        if ((int)builder.name >= elementByIdLimit) {
+            int limit = elementByIdLimit ? elementByIdLimit : MAP_INIT;
+            while (limit <= (int)builder.name) limit *= 2;
+            ElementById = slRealloc(ElementById, limit * sizeof(int));
+            memset(ElementById + elementByIdLimit, 0xFF, (limit - elementByIdLimit) * sizeof(int));
+            elementByIdLimit = limit;
+        }
+        ElementById[builder.name] = ptr->slot;
+    }
+    drawOrderAppend(ptr);
+    initElement(ptr, builder_);
+    return ptr;
+}
+
+// On top of everything created before it. Holes are squeezed out first once they're half the list, so churn
+// settles into a list that doesn't grow
+static void drawOrderAppend(SL_UIElement* element) {
+    if (drawOrderHoles > drawOrderCount / 2) {
+        int count = 0;
+        for (int i = 0; i < drawOrderCount; i++) {
+            if (DrawOrder[i] < 0) continue;
+            elementAt(DrawOrder[i])->draw_index = count;
+            DrawOrder[count++] = DrawOrder[i];
+        }
+        drawOrderCount = count;
+        drawOrderHoles = 0;
+    }
+    if (drawOrderCount == drawOrderLimit) {
+        drawOrderLimit = drawOrderLimit ? drawOrderLimit * 2 : MAP_INIT;
+        DrawOrder = slRealloc(DrawOrder, drawOrderLimit * sizeof(int));
+    }
+    element->draw_index = drawOrderCount;
+    DrawOrder[drawOrderCount++] = element->slot;
+}
+
+// Most recently freed slot first, it's the likeliest to still be in cache
+static SL_UIElement* allocElement(void) {
+    if (elementFreeList >= 0) {
+        SL_UIElement* ptr = elementAt(elementFreeList);
+        elementFreeList = ptr->next_free;
+        elementFreeCount--;
+        return ptr;
+    }
+    if (elementCount == elementPageCount * ELEMENT_PAGE_SIZE) {
+        ElementPages = slRealloc(ElementPages, (elementPageCount + 1) * sizeof(SL_UIElement*));
+        ElementPages[elementPageCount++] = slCalloc(ELEMENT_PAGE_SIZE, sizeof(SL_UIElement));
+    }
+    SL_UIElement* ptr = elementAt(elementCount);
+    ptr->slot = elementCount++;
+    ptr->generation = 1;
+    return ptr;
+}
+
+int SL_CreateElements(SL_UIElementBuilder** builder_, int count, SL_UIElement** out) {
+    if (!builder_ || !*builder_ || !out || count <= 0) {
+        SDL_SetError("SL_CreateElements needs a builder, somewhere to put the elements and a count above 0");
+        return -1;
+    }
+    const SL_UIElementBuilder* builder = *builder_;
+    if (count > elementFreeCount) {
+        reserveElements(count - elementFreeCount);
+    }
+    for (int i = 0; i < count; i++) {
+        // Every element takes over a set of the builder's font references, the last one takes the builder's own
+        if (i < count - 1) {
+            SL_RetainFont(builder->font);
+            for (int k = 0; k < builder->num_text_objects; k++) {
+                SL_RetainFont(builder->text_builders[k].font);
+            }
+        }
+        out[i] = createElement(builder);
+    }
+    free((*builder_)->text_builders);
+    free(*builder_);
+    *builder_ = NULL;
+    return 0;
+}
+
+void SL_FreeElements(SL_UIElement* const* elements, int count) {
+    if (!elements) return;
+    for (int i = 0; i < count; i++) {
+        SL_FreeElement(elements[i]);
+    }
+}
+
+SL_Handle SL_GetElementHandle(const SL_UIElement* element) {
+    if (!element || !(element->flags & SL_INNERFLAG_IN_USE)) return SL_NO_HANDLE;
+    return ((SL_Handle)element->generation << HANDLE_INDEX_BITS) | (SL_Handle)(uint32_t)element->slot;
+}
+
+SL_UIElement* SL_GetElementByHandle(SL_Handle handle) {
+    uint32_t slot = (uint32_t)(handle & HANDLE_INDEX_MASK);
+    if (handle == SL_NO_HANDLE || slot >= (uint32_t)elementCount) return NULL;
+    SL_UIElement* element = elementAt((int)slot);
+    if (!(element->flags & SL_INNERFLAG_IN_USE) || element->generation != handle >> HANDLE_INDEX_BITS) return NULL;
+    return element;
+}
+
+void SL_TrimElementPool(void) {
+    for (int i = 0; i < elementCount; i++) {
+        SL_UIElement* element = elementAt(i);
+        if (!(element->flags & SL_INNERFLAG_IN_USE)) {
+            releaseElementSlot(element);
+        }
+    }
+}
+
+// Everything but finding the element a home - reloads rebuild elements in place with this
+static void initElement(SL_UIElement* ptr, const SL_UIElementBuilder* builder_) {
+    const SL_UIElementBuilder builder = *builder_;
+
+    ptr->id = builder.name;
+    ptr->name = SL_IdName(builder.name);
+
+    if ((builder.flags & SL_INNERFLAG_ABSOLUTE) == SL_INNERFLAG_ABSOLUTE) {
+        ptr->src_rect.x = builder.xab;
+        ptr->src_rect.y = builder.yab;
+        ptr->src_rect.w = builder.wab;
+        ptr->src_rect.h = builder.hab;
+    }
+    else {
+        ptr->src_rect.x = (int)(builder.x * (float)screen_width);
+        ptr->src_rect.y = (int)(builder.y * (float)screen_height);
+        ptr->src_rect.w = (int)(builder.w * (float)screen_width);
+        ptr->src_rect.h = (int)(builder.h * (float)screen_height);
+    }
+    ptr->flags = builder.flags | SL_INNERFLAG_DAMAGED | SL_INNERFLAG_IN_USE;
+
+    applySkin(ptr, builder.skin, builder.skin_region.w > 0 ? &builder.skin_region : NULL);
+    ptr->tint = Color_White;
+    BakeSkin(ptr);
+
+    // A recycled slot still has the text array and lookup table from whatever was in it last, those only grow
+    ptr->textCount = 0;
+    if (ptr->TextObjectMap) {
+        memory_stats.elements -= sizeof(SL_NameIndex) + nameIndexBytes(ptr->TextObjectMap);
+        nameIndexClear(ptr->TextObjectMap);
+    }
+    if (builder.num_text_objects > ptr->textLimit) {
+        ptr->TextObjects = slRealloc(ptr->TextObjects, builder.num_text_objects * sizeof(SL_TextObject));
+        memset(ptr->TextObjects + ptr->textLimit, 0, (builder.num_text_objects - ptr->textLimit) * sizeof(SL_TextObject));
+        memory_stats.text += (builder.num_text_objects - ptr->textLimit) * sizeof(SL_TextObject);
+        ptr->textLimit = builder.num_text_objects;
+    }
+    if (builder.num_text_objects > 0 && !ptr->TextObjectMap) {
+        ptr->TextObjectMap = slMalloc(sizeof(SL_NameIndex));
+        nameIndexInit(ptr->TextObjectMap, TEXT_MAP_INIT);
+    }
+
+    for (int i = 0; i < builder.num_text_objects; i++) {
+        int idx = ptr->textCount++;
+        SL_TextObject* obj_ptr = &ptr->TextObjects[idx];
+        SL_Font* font = builder.text_builders[i].font ? builder.text_builders[i].font : builder.font;
+        InitTextObject(
+                obj_ptr,
+                font,
+                builder.text_builders[i].text,
+                builder.text_builders[i].size,
+                builder.text_builders[i].x,
+                builder.text_builders[i].y,
+                ptr->src_rect.w
+        );
+        SL_Id id = builder.text_builders[i].id;
+        obj_ptr->id = id;
+        obj_ptr->align = builder.text_builders[i].align;
+        obj_ptr->c = builder.text_builders[i].color;
+        nameIndexInsert(ptr->TextObjectMap, intern_names[id], intern_hashes[id], idx);
+    }
+    if (ptr->TextObjectMap) {
+        memory_stats.elements += sizeof(SL_NameIndex) + nameIndexBytes(ptr->TextObjectMap);
+    }
+
+    // The builder's reference moves to the element, the text objects took their own
+    ptr->font = builder.font;
+    for (int i = 0; i < builder.num_text_objects; i++) {
+        SL_ReleaseFont(builder.text_builders[i].font);
+    }
+
+    ptr->list = NULL;
+    if (builder.list_callback) {
+        SL_ListState* list = slCalloc(1, sizeof(SL_ListState));
+        list->callback = builder.list_callback;
+        list->userdata = builder.list_userdata;
+        list->row_count = builder.list_rows;
+        list->row_height = builder.list_row_height;
+        list->text_size = builder.list_text_size;
+        memcpy(list->columns, builder.list_columns, sizeof(list->columns));
+        list->column_count = builder.list_column_count;
+        ptr->list = list;
+        memory_stats.elements += sizeof(SL_ListState);
+    }
+}
+
+// The slot goes back on the free list with its buffers, the next element created reuses them
+void SL_FreeElement(SL_UIElement* element) {
+    if (!element || !(element->flags & SL_INNERFLAG_IN_USE)) return;
+    damageElement(element);
+    clearElement(element);
+    if (element->id != SL_NO_ID && SL_GetElementById(element->id) == element) {
+        ElementById[element->id] = -1;
+    }
+    DrawOrder[element->draw_index] = -1;
+    drawOrderHoles++;
+    element->flags = 0;
+    // Wrapping would let a handle from billions of frees ago find whatever's here next, so the slot is just never
+    // used again. Generations start at 1, so no handle is ever SL_NO_HANDLE
+    if (element->generation == HANDLE_GENERATION_MAX) {
+        releaseElementSlot(element);
+        return;
+    }
+    element->generation++;
+    element->next_free = elementFreeList;
+    elementFreeList = element->slot;
+    elementFreeCount++;
+}
+
+// Drops the text and fonts, the buffers behind them stay with the element to be reused
+static void clearElement(SL_UIElement* element) {
+    for (int k = 0; k < element->textCount; k++) {
+        ParkTextObject(&element->TextObjects[k]);
+    }
+    element->textCount = 0;
+    freeList(element);
+    SL_ReleaseFont(element->font);
+    element->font = NULL;
+}
+
+// Frees whatever buffers a cleared slot was holding on to
+static void releaseElementSlot(SL_UIElement* element) {
+    for (int k = 0; k < element->textLimit; k++) {
+        DestroyTextObject(&element->TextObjects[k]);
+    }
+    free(element->TextObjects);
+    memory_stats.text -= element->textLimit * sizeof(SL_TextObject);
+    if (element->TextObjectMap) {
+        memory_stats.elements -= sizeof(SL_NameIndex) + nameIndexBytes(element->TextObjectMap);
+        nameIndexFree(element->TextObjectMap);
+        free(element->TextObjectMap);
+    }
+    element->TextObjects = NULL;
+    element->TextObjectMap = NULL;
+    element->textLimit = 0;
+}
+
+// Blueprints
+
+// Makes sure count more elements fit without growing the page list midway
+static void reserveElements(int count) {
+    int pages = (elementCount + count + ELEMENT_PAGE_SIZE - 1) / ELEMENT_PAGE_SIZE;
+    if (pages <= elementPageCount) return;
+    ElementPages = slRealloc(ElementPages, pages * sizeof(SL_UIElement*));
+    while (elementPageCount < pages) {
+        ElementPages[elementPageCount++] = slCalloc(ELEMENT_PAGE_SIZE, sizeof(SL_UIElement));
+    }
+}
+
+// Whole file in one block with a terminator after it, the text loader parses it in place
+static char* readFile(const char* path, size_t* size) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        SDL_SetError("Couldn't open %s", path);
+        return NULL;
+    }
+    fseek(file, 0, SEEK_END);
+    long len = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char* data = len >= 0 ? slMalloc((size_t)len + 1) : NULL;
+    if (!data || fread(data, 1, (size_t)len, file) != (size_t)len) {
+        free(data);
+        fclose(file);
+        SDL_SetError("Couldn't read %s", path);
+        return NULL;
+    }
+    fclose(file);
+    data[len] = '\0';
+    *size = (size_t)len;
+    return data;
+}
+
+static const char* blueprintString(const SL_BlueprintState* state, uint32_t offset) {
+    return offset ? state->strings + offset : NULL;
+}
+
+static int findBlueprintResource(const SL_BlueprintState* state, uint32_t name, int kind) {
+    const char* str = blueprintString(state, name);
+    if (!str) return -1;
+    // Only ever a handful, cheaper than hashing the name
+    for (int i = 0; i < state->resource_count; i++) {
+        if (state->resources[i].kind == kind && strcmp(intern_names[state->resources[i].name], str) == 0) return i;
+    }
+    SDL_SetError("%s: no %s called %s", state->path, kind == BLUEPRINT_SKIN ? "skin" : "font", str);
+    return -1;
+}
+
+// Compiling copies the string over to the output table, loading resolves the texture or font right away
+static int blueprintResource(SL_BlueprintState* state, const SL_BlueprintResource* res) {
+    if (!res->name || !res->path) {
+        SDL_SetError("%s: resources need a name and a path", state->path);
+        return -1;
+    }
+    if (state->out) {
+        SL_BlueprintResource copy = *res;
+        copy.name = compileString(state, res->name);
+        copy.path = compileString(state, res->path);
+        copy.texture = compileString(state, res->texture);
+        appendRecord((void**)&state->out->resources, &state->out->resource_count, &state->out->resource_limit,
+                     &copy, sizeof(copy));
+        return 0;
+    }
+
+    const char* path = blueprintString(state, res->path);
+    const char* texture_path = blueprintString(state, res->texture);
+    SL_BlueprintSlot slot = {SL_Intern(blueprintString(state, res->name)), (int)res->kind, NULL, res->region, NULL};
+    if (texture_path) {
+        slot.texture = sourceTexture(texture_path, state->loader, state->userdata);
+    }
+    if (res->kind == BLUEPRINT_SKIN) {
+        if (!slot.texture) {
+            SDL_SetError("%s: couldn't load skin %s", state->path, texture_path);
+            return -1;
+        }
+    }
+    else {
+        slot.font = SL_LoadFont(slot.texture, path);
+        if (!slot.font) return -1;
+    }
+
+    if (state->resource_count == state->resource_limit) {
+        state->resource_limit = state->resource_limit ? state->resource_limit * 2 : BLUEPRINT_INIT;
+        state->resources = slRealloc(state->resources, state->resource_limit * sizeof(SL_BlueprintSlot));
+    }
+    state->resources[state->resource_count++] = slot;
+    return 0;
+}
+
+static int blueprintElement(SL_BlueprintState* state, const SL_BlueprintElement* e, const SL_BlueprintText* texts) {
+    if (state->out) {
+        SL_BlueprintElement copy = *e;
+        copy.name = compileString(state, e->name);
+        copy.skin = compileString(state, e->skin);
+        copy.font = compileString(state, e->font);
+        appendRecord((void**)&state->out->elements, &state->out->element_count, &state->out->element_limit,
+                     &copy, sizeof(copy));
+        for (int i = 0; i < e->text_count; i++) {
+            SL_BlueprintText t = texts[i];
+            t.id = compileString(state, texts[i].id);
+            t.value = compileString(state, texts[i].value);
+            t.font = compileString(state, texts[i].font);
+            appendRecord((void**)&state->out->texts, &state->out->text_count, &state->out->text_limit, &t, sizeof(t));
+        }
+        return 0;
+    }
+
+    if (state->reload && !e->name) return 0;
+
+    // Same thing the builder functions put together, just on the stack
+    SL_TextObjBuilder text_builders[MAX_TEXT_OBJS];
+    SL_UIElementBuilder builder;
+    memset(&builder, 0, sizeof(builder));
+    builder.name = e->name ? SL_Intern(blueprintString(state, e->name)) : SL_NO_ID;
+    builder.flags = e->flags;
+    builder.x = e->rel[0];
+    builder.y = e->rel[1];
+    builder.w = e->rel[2];
+    builder.h = e->rel[3];
+    builder.xab = e->rect.x;
+    builder.yab = e->rect.y;
+    builder.wab = e->rect.w;
+    builder.hab = e->rect.h;
+    builder.align = (SL_TextAlign)e->align;
+    builder.text_builders = text_builders;
+    builder.num_text_objects = e->text_count;
+
+    if (e->skin) {
+        int r = findBlueprintResource(state, e->skin, BLUEPRINT_SKIN);
+        if (r < 0) return -1;
+        builder.skin = state->resources[r].texture;
+        builder.skin_region = state->resources[r].region;
+    }
+    SL_Font* element_font = NULL;
+    if (e->font) {
+        int r = findBlueprintResource(state, e->font, BLUEPRINT_FONT);
+        if (r < 0) return -1;
+        element_font = state->resources[r].font;
+    }
+    for (int i = 0; i < e->text_count; i++) {
+        const SL_BlueprintText* t = &texts[i];
+        SL_Font* font = element_font;
+        if (t->font) {
+            int r = findBlueprintResource(state, t->font, BLUEPRINT_FONT);
+            if (r < 0) return -1;
+            font = state->resources[r].font;
+        }
+        if (!font) {
+            SDL_SetError("%s: text %s has no font", state->path, blueprintString(state, t->id));
+            return -1;
+        }
+        const char* value = t->value ? blueprintString(state, t->value) : "";
+        SL_TextObjBuilder b = {
+                .id = SL_Intern(t->id ? blueprintString(state, t->id) : value),
+                .font = t->font ? font : NULL,
+                .align = (SL_TextAlign)t->align,
+                .color = t->color,
+                .text = value,
+                .x = t->x,
+                .y = t->y,
+                .size = t->size
+        };
+        text_builders[i] = b;
+    }
+
+    // createElement takes these over, like the builder functions would have
+    SL_RetainFont(element_font);
+    builder.font = element_font;
+    for (int i = 0; i < e->text_count; i++) {
+        SL_RetainFont(text_builders[i].font);
+    }
+    SL_UIElement* existing = state->reload ? SL_GetElementById(builder.name) : NULL;
+    if (existing) {
+        rebuildElement(existing, &builder);
+    }
+    else {
+        createElement(&builder);
+    }
+    state->created++;
+    return 0;
+}
+
+static int parseAlign(const char* value, int* align) {
+    if (strcmp(value, "left") == 0) *align = SL_TEXT_ALIGN_LEFT;
+    else if (strcmp(value, "center") == 0) *align = SL_TEXT_ALIGN_CENTER;
+    else if (strcmp(value, "right") == 0) *align = SL_TEXT_ALIGN_RIGHT;
+    else return -1;
+    return 0;
+}
+
+// Comma separated, returns how many were read
+static int parseInts(const char* value, int* out, int count) {
+    int n = 0;
+    char* end;
+    while (n < count) {
+        out[n] = (int)strtol(value, &end, 10);
+        if (end == value) break;
+        n++;
+        if (*end != ',') break;
+        value = end + 1;
+    }
+    return n;
+}
+
+static int parseFloats(const char* value, float* out, int count) {
+    int n = 0;
+    char* end;
+    while (n < count) {
+        out[n] = strtof(value, &end);
+        if (end == value) break;
+        n++;
+        if (*end != ',') break;
+        value = end + 1;
+    }
+    return n;
+}
+
+/*
+ * Splits the next key=value off a line, unquoting the value in place. Quoted values can hold spaces and
+ * \", \\ and \n escapes. Returns 0 at the end of the line, -1 on a malformed field.
+ */
+static int nextField(char** cursor, char** key, char** value) {
+    char* c = *cursor;
+    while (*c == ' ' || *c == '\t') c++;
+    if (*c == '\0') return 0;
+    *key = c;
+    while (*c && *c != '=' && *c != ' ' && *c != '\t') c++;
+    if (*c != '=') return -1;
+    *c++ = '\0';
+
+    if (*c == '"') {
+        char* out = ++c;
+        *value = out;
+        while (*c && *c != '"') {
+            if (*c == '\\' && c[1]) {
+                c++;
+                *out++ = *c == 'n' ? '\n' : *c;
+                c++;
+            }
+            else {
+                *out++ = *c++;
+            }
+        }
+        if (*c != '"') return -1;
+        c++;
+        *out = '\0';
+    }
+    else {
+        *value = c;
+        while (*c && *c != ' ' && *c != '\t') c++;
+        if (*c) *c++ = '\0';
+    }
+    *cursor = c;
+    return 1;
+}
+
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "cert-err34-c"
+// One pass over the file - resources go out as they're read, elements once their text lines are done
+static int parseBlueprintText(SL_BlueprintState* state, char* data) {
+    state->strings = data;
+    SL_BlueprintElement element;
+    SL_BlueprintText texts[MAX_TEXT_OBJS];
+    int have_element = 0;
+    int line_number = 0;
+    int reserve = 0;
+    char* line = data;
+
+    while (line) {
+        char* next = strchr(line, '\n');
+        if (next) *next++ = '\0';
+        size_t len = strlen(line);
+        if (len && line[len - 1] == '\r') line[len - 1] = '\0';
+        line_number++;
+
+        char* c = line;
+        while (*c == ' ' || *c == '\t') c++;
+        if (*c == '\0' || *c == '#') {
+            line = next;
+            continue;
+        }
+        char* kind = c;
+        while (*c && *c != ' ' && *c != '\t') c++;
+        if (*c) *c++ = '\0';
+
+        char* key;
+        char* value;
+        int result;
+        if (strcmp(kind, "element") == 0) {
+            if (have_element && blueprintElement(state, &element, texts) != 0) return -1;
+            memset(&element, 0, sizeof(element));
+            element.flags = SL_INNERFLAG_ACTIVE;
+            have_element = 1;
+            while ((result = nextField(&c, &key, &value)) > 0) {
+                int ok = 1;
+                if (strcmp(key, "name") == 0) element.name = (uint32_t)(value - data);
+                else if (strcmp(key, "skin") == 0) element.skin = (uint32_t)(value - data);
+                else if (strcmp(key, "font") == 0) element.font = (uint32_t)(value - data);
+                else if (strcmp(key, "active") == 0) {
+                    if (atoi(value)) element.flags |= SL_INNERFLAG_ACTIVE;
+                    else element.flags &= ~SL_INNERFLAG_ACTIVE;
+                }
+                else if (strcmp(key, "align") == 0) ok = parseAlign(value, &element.align) == 0;
+                else if (strcmp(key, "rect") == 0) {
+                    ok = parseInts(value, &element.rect.x, 4) == 4;
+                    element.flags |= SL_INNERFLAG_ABSOLUTE;
+                }
+                else if (strcmp(key, "rel") == 0) {
+                    ok = parseFloats(value, element.rel, 4) == 4;
+                    element.flags &= ~SL_INNERFLAG_ABSOLUTE;
+                }
+                else ok = 0;
+                if (!ok) break;
+            }
+        }
+        else if (strcmp(kind, "text") == 0) {
+            if (!have_element) {
+                SDL_SetError("%s:%d: text before any element", state->path, line_number);
+                return -1;
+            }
+            if (element.text_count == MAX_TEXT_OBJS) {
+                SDL_SetError("%s:%d: more than %d texts on one element", state->path, line_number, MAX_TEXT_OBJS);
+                return -1;
+            }
+            SL_BlueprintText* t = &texts[element.text_count++];
+            memset(t, 0, sizeof(*t));
+            t->align = element.align;
+            t->color = Color_White;
+            while ((result = nextField(&c, &key, &value)) > 0) {
+                int ok = 1;
+                if (strcmp(key, "id") == 0) t->id = (uint32_t)(value - data);
+                else if (strcmp(key, "value") == 0) t->value = (uint32_t)(value - data);
+                else if (strcmp(key, "font") == 0) t->font = (uint32_t)(value - data);
+                else if (strcmp(key, "x") == 0) t->x = atoi(value);
+                else if (strcmp(key, "y") == 0) t->y = atoi(value);
+                else if (strcmp(key, "size") == 0) t->size = (float)atof(value);
+                else if (strcmp(key, "align") == 0) ok = parseAlign(value, &t->align) == 0;
+                else if (strcmp(key, "color") == 0) {
+                    int rgba[4] = {255, 255, 255, 255};
+                    ok = parseInts(value, rgba, 4) >= 3;
+                    t->color = (SDL_Color){(Uint8)rgba[0], (Uint8)rgba[1], (Uint8)rgba[2], (Uint8)rgba[3]};
+                }
+                else ok = 0;
+                if (!ok) break;
+            }
+        }
+        else if (strcmp(kind, "skin") == 0 || strcmp(kind, "font") == 0) {
+            SL_BlueprintResource res;
+            memset(&res, 0, sizeof(res));
+            res.kind = strcmp(kind, "skin") == 0 ? BLUEPRINT_SKIN : BLUEPRINT_FONT;
+            while ((result = nextField(&c, &key, &value)) > 0) {
+                int ok = 1;
+                if (strcmp(key, "name") == 0) res.name = (uint32_t)(value - data);
+                else if (strcmp(key, "path") == 0) res.path = (uint32_t)(value - data);
+                else if (strcmp(key, "texture") == 0) res.texture = (uint32_t)(value - data);
+                else if (strcmp(key, "region") == 0 && res.kind == BLUEPRINT_SKIN) {
+                    ok = parseInts(value, &res.region.x, 4) == 4;
+                }
+                else ok = 0;
+                if (!ok) break;
+            }
+            // A skin's image is its path, a font's is its texture
+            if (res.kind == BLUEPRINT_SKIN) {
+                res.texture = res.path;
+            }
+            if (result == 0 && blueprintResource(state, &res) != 0) return -1;
+        }
+        else if (strcmp(kind, "blueprint") == 0) {
+            while ((result = nextField(&c, &key, &value)) > 0) {
+                if (strcmp(key, "elements") == 0) reserve = atoi(value);
+                else if (strcmp(key, "texts") != 0) break;
+            }
+            if (result == 0 && !state->out) {
+                reserveElements(reserve);
+            }
+        }
+        else {
+            SDL_SetError("%s:%d: unknown record %s", state->path, line_number, kind);
+            return -1;
+        }
+
+        if (result < 0) {
+            SDL_SetError("%s:%d: malformed field", state->path, line_number);
+            return -1;
+        }
+        if (result > 0) {
+            SDL_SetError("%s:%d: bad field %s", state->path, line_number, key);
+            return -1;
+        }
+        line = next;
+    }
+    if (have_element && blueprintElement(state, &element, texts) != 0) return -1;
+    return 0;
+}
+#pragma clang diagnostic pop
+
+// Compiled blueprint - the records are already resolved, so this only checks they're in bounds and walks them
+static int loadBlueprintBinary(SL_BlueprintState* state, const char* data, size_t size) {
+    const SL_BlueprintFileHeader* header = (const SL_BlueprintFileHeader*)data;
+    if (size < sizeof(SL_BlueprintFileHeader)
+        || header->version != BLUEPRINT_FILE_VERSION
+        || header->element_size != sizeof(SL_BlueprintElement)
+        || header->resource_offset + (size_t)header->resource_count * sizeof(SL_BlueprintResource) > size
+        || header->element_offset + (size_t)header->element_count * sizeof(SL_BlueprintElement) > size
+        || header->text_offset + (size_t)header->text_count * sizeof(SL_BlueprintText) > size
+        || header->string_offset + (size_t)header->string_size > size
+        || header->string_size == 0
+        || data[header->string_offset + header->string_size - 1] != '\0') {
+        SDL_SetError("Bad compiled blueprint %s", state->path);
+        return -1;
+    }
+    const SL_BlueprintResource* resources = (const SL_BlueprintResource*)(data + header->resource_offset);
+    const SL_BlueprintElement* elements = (const SL_BlueprintElement*)(data + header->element_offset);
+    const SL_BlueprintText* texts = (const SL_BlueprintText*)(data + header->text_offset);
+    state->strings = data + header->string_offset;
+
+    // Every string offset has to land inside the table, and the texts have to add up
+    uint32_t limit = header->string_size;
+    uint32_t text_total = 0;
+    int bad = 0;
+    for (uint32_t i = 0; i < header->resource_count; i++) {
+        bad |= resources[i].name >= limit || resources[i].path >= limit || resources[i].texture >= limit;
+    }
+    for (uint32_t i = 0; i < header->element_count; i++) {
+        bad |= elements[i].name >= limit || elements[i].skin >= limit || elements[i].font >= limit;
+        bad |= elements[i].text_count < 0 || elements[i].text_count > MAX_TEXT_OBJS;
+        text_total += (uint32_t)elements[i].text_count;
+    }
+    for (uint32_t i = 0; i < header->text_count; i++) {
+        bad |= texts[i].id >= limit || texts[i].value >= limit || texts[i].font >= limit;
+    }
+    if (bad || text_total != header->text_count) {
+        SDL_SetError("Bad compiled blueprint %s", state->path);
+        return -1;
+    }
+
+    return walkBlueprint(state, resources, (int)header->resource_count, elements, (int)header->element_count, texts);
+}
+
+// Records that are already in memory, compiled or parsed ahead of time by the reload thread
+static int walkBlueprint(SL_BlueprintState* state, const SL_BlueprintResource* resources, int resource_count,
+                         const SL_BlueprintElement* elements, int element_count, const SL_BlueprintText* texts) {
+    reserveElements(element_count);
+    for (int i = 0; i < resource_count; i++) {
+        if (blueprintResource(state, &resources[i]) != 0) return -1;
+    }
+    for (int i = 0; i < element_count; i++) {
+        if (blueprintElement(state, &elements[i], texts) != 0) return -1;
+        texts += elements[i].text_count;
+    }
+    return 0;
+}
+
+// The elements hold their own font references by now
+static void blueprintStateFree(SL_BlueprintState* state) {
+    for (int i = 0; i < state->resource_count; i++) {
+        SL_ReleaseFont(state->resources[i].font);
+    }
+    free(state->resources);
+    state->resources = NULL;
+    state->resource_count = 0;
+}
+
+int SL_LoadBlueprint(const char* path, SL_TextureLoader loader, void* userdata) {
+    if ((global_flags & SL_FLAGS_MANAGE_MEMORY) != SL_FLAGS_MANAGE_MEMORY) {
+        SDL_SetError("Blueprints need SL_FLAGS_MANAGE_MEMORY");
+        return -1;
+    }
+    if (!path) return -1;
+    // Even one that fails to load, so fixing it gets picked up by hot reload
+    sourceAdd(SOURCE_BLUEPRINT, path, loader, userdata);
+    size_t size;
+    char* data = readFile(path, &size);
+    if (!data) return -1;
+
+    SL_BlueprintState state;
+    memset(&state, 0, sizeof(state));
+    state.path = path;
+    state.loader = loader;
+    state.userdata = userdata;
+
+    int result;
+    if (size >= sizeof(SL_BlueprintFileHeader) && memcmp(data, BLUEPRINT_FILE_MAGIC, 4) == 0) {
+        result = loadBlueprintBinary(&state, data, size);
+    }
+    else {
+        result = parseBlueprintText(&state, data);
+    }
+
+    blueprintStateFree(&state);
+    free(data);
+    return result == 0 ? state.created : -1;
+}
+
+static void appendRecord(void** records, int* count, int* limit, const void* record, size_t size) {
+    if (*count == *limit) {
+        *limit = *limit ? *limit * 2 : BLUEPRINT_INIT;
+        *records = slRealloc(*records, *limit * size);
+    }
+    memcpy((char*)*records + *count * size, record, size);
+    (*count)++;
+}
+
+// Copies a string from the source into the compiled string table, 0 stays 0
+static uint32_t compileString(SL_BlueprintState* state, uint32_t offset) {
+    const char* str = blueprintString(state, offset);
+    if (!str) return 0;
+    SL_BlueprintOutput* out = state->out;
+    size_t len = strlen(str) + 1;
+    if (out->string_size + len > out->string_limit) {
+        while (out->string_size + len > out->string_limit) {
+            out->string_limit = out->string_limit ? out->string_limit * 2 : INTERN_PAGE_SIZE;
+        }
+        out->strings = slRealloc(out->strings, out->string_limit);
+    }
+    memcpy(out->strings + out->string_size, str, len);
+    uint32_t at = (uint32_t)out->string_size;
+    out->string_size += len;
+    return at;
+}
+
+int SL_CompileBlueprint(const char* bp_path, const char* out_path) {
+    size_t size;
+    char* data = bp_path ? readFile(bp_path, &size) : NULL;
+    if (!data) return -1;
+
+    SL_BlueprintOutput out;
+    blueprintOutputInit(&out);
+    SL_BlueprintState state;
+    memset(&state, 0, sizeof(state));
+    state.path = bp_path;
+    state.out = &out;
+
+    int result = parseBlueprintText(&state, data);
+    if (result == 0) {
+        SL_BlueprintFileHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, BLUEPRINT_FILE_MAGIC, sizeof(header.magic));
+        header.version = BLUEPRINT_FILE_VERSION;
+        header.element_size = sizeof(SL_BlueprintElement);
+        header.resource_count = (uint32_t)out.resource_count;
+        header.element_count = (uint32_t)out.element_count;
+        header.text_count = (uint32_t)out.text_count;
+        header.resource_offset = sizeof(SL_BlueprintFileHeader);
+        header.element_offset = header.resource_offset + header.resource_count * sizeof(SL_BlueprintResource);
+        header.text_offset = header.element_offset + header.element_count * sizeof(SL_BlueprintElement);
+        header.string_offset = header.text_offset + header.text_count * sizeof(SL_BlueprintText);
+        header.string_size = (uint32_t)out.string_size;
+
+        char tmp_path[4096];
+        FILE* file = openReplacement(out_path, "wb", tmp_path, sizeof(tmp_path));
+        if (!file) {
+            result = -1;
+        }
+        else {
+            int failed = fwrite(&header, sizeof(header), 1, file) != 1
+                || fwrite(out.resources, sizeof(SL_BlueprintResource), out.resource_count, file) != (size_t)out.resource_count
+                || fwrite(out.elements, sizeof(SL_BlueprintElement), out.element_count, file) != (size_t)out.element_count
+                || fwrite(out.texts, sizeof(SL_BlueprintText), out.text_count, file) != (size_t)out.text_count
+                || fwrite(out.strings, 1, out.string_size, file) != out.string_size;
+            result = commitReplacement(file, failed, tmp_path, out_path);
+        }
+    }
+
+    blueprintOutputFree(&out);
+    free(data);
+    return result;
+}
+
+static void blueprintOutputInit(SL_BlueprintOutput* out) {
+    memset(out, 0, sizeof(SL_BlueprintOutput));
+    // Offset 0 means no string, so the table starts with a spare byte
+    out->strings = slMalloc(INTERN_PAGE_SIZE);
+    out->string_limit = INTERN_PAGE_SIZE;
+    out->strings[0] = '\0';
+    out->string_size = 1;
+}
+
+static void blueprintOutputFree(SL_BlueprintOutput* out) {
+    free(out->resources);
+    free(out->elements);
+    free(out->texts);
+    free(out->strings);
+    memset(out, 0, sizeof(SL_BlueprintOutput));
+}
+
+// Source files and hot reload
+
+static int sourceFind(int kind, const char* path) {
+    for (int i = 0; i < sourceCount; i++) {
+        if (Sources[i].kind == kind && strcmp(Sources[i].path, path) == 0) return i;
+    }
+    return -1;
+}
+
+// Safe to call with the reload thread running, it only ever looks entries up under the lock
+static int sourceAdd(int kind, const char* path, SL_TextureLoader loader, void* userdata) {
+    int idx = sourceFind(kind, path);
+    if (idx >= 0) return idx;
+
+    path = SL_IdName(SL_Intern(path));
+    const char* slash = strrchr(path, '/');
+    SL_SourceFile source = {kind, path, slash ? slash + 1 : path, -1, loader, userdata, NULL};
+    if (reload_lock) SDL_LockMutex(reload_lock);
+    if (sourceCount == sourceLimit) {
+        sourceLimit = sourceLimit ? sourceLimit * 2 : BLUEPRINT_INIT;
+        Sources = slRealloc(Sources, sourceLimit * sizeof(SL_SourceFile));
+    }
+    idx = sourceCount++;
+    Sources[idx] = source;
+    hotReloadWatch(&Sources[idx]);
+    if (reload_lock) SDL_UnlockMutex(reload_lock);
+    return idx;
+}
+
+// Asks the loader for each path once, later blueprints using the same image share the texture
+static SDL_Texture* sourceTexture(const char* path, SL_TextureLoader loader, void* userdata) {
+    int idx = sourceFind(SOURCE_TEXTURE, path);
+    if (idx >= 0 && Sources[idx].texture) return Sources[idx].texture;
+    SDL_Texture* texture = loader ? loader(path, userdata) : NULL;
+    if (texture) {
+        idx = sourceAdd(SOURCE_TEXTURE, path, loader, userdata);
+        Sources[idx].texture = texture;
+    }
+    return texture;
+}
+
+static void sourcesQuit(void) {
+    free(Sources);
+    Sources = NULL;
+    sourceCount = 0;
+    sourceLimit = 0;
+}
+
+// Keeps what a reload can't know about - whether the game has the element showing, and its tint
+static void rebuildElement(SL_UIElement* element, const SL_UIElementBuilder* builder) {
+    damageElement(element);
+    unsigned short active = element->flags & SL_INNERFLAG_ACTIVE;
+    SDL_Color tint = element->tint;
+    clearElement(element);
+    initElement(element, builder);
+    element->flags = (element->flags & ~SL_INNERFLAG_ACTIVE) | active;
+    element->tint = tint;
+    TintSkin(element);
+}
+
+#ifdef SL_HOT_RELOAD
+// Watches the directory rather than the file, editors tend to save by writing a new file over the old one
+static void hotReloadWatch(SL_SourceFile* source) {
+    if (reload_fd < 0 || source->wd >= 0) return;
+    char dir[4096];
+    size_t len = (size_t)(source->name - source->path);
+    if (len == 0) {
+        strcpy(dir, ".");
+    }
+    else {
+        if (len >= sizeof(dir)) return;
+        memcpy(dir, source->path, len - 1 ? len - 1 : 1);
+        dir[len - 1 ? len - 1 : 1] = '\0';
+    }
+    source->wd = inotify_add_watch(reload_fd, dir, IN_CLOSE_WRITE | IN_MOVED_TO);
+}
+
+// Runs on the reload thread - reads and parses, never touches anything the main thread uses
+static SL_ReloadResult* hotReloadParse(int idx, int kind, const char* path) {
+    SL_ReloadResult* result = slCalloc(1, sizeof(SL_ReloadResult));
+    result->source = idx;
+    result->ok = 1;
+    if (kind == SOURCE_FONT) {
+        result->ok = loadFont(&result->font, path) == 0;
+    }
+    else if (kind == SOURCE_BLUEPRINT) {
+        size_t size;
+        char* data = readFile(path, &size);
+        if (!data) {
+            result->ok = 0;
+        }
+        else if (size >= sizeof(SL_BlueprintFileHeader) && memcmp(data, BLUEPRINT_FILE_MAGIC, 4) == 0) {
+            result->compiled = data;
+            result->compiled_size = size;
+        }
+        else {
+            SL_BlueprintState state;
+            memset(&state, 0, sizeof(state));
+            state.path = path;
+            state.out = &result->blueprint;
+            blueprintOutputInit(state.out);
+            result->ok = parseBlueprintText(&state, data) == 0;
+            free(data);
+        }
+    }
+    if (!result->ok) {
+        snprintf(result->error, sizeof(result->error), "%s", SDL_GetError());
+    }
+    return result;
+}
+
+static int hotReloadThread(void* data) {
+    (void)data;
+    char events[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    int* changed = NULL;
+    int changed_count = 0;
+    int changed_limit = 0;
+
+    while (!SDL_AtomicGet(&reload_quit)) {
+        struct pollfd fd = {reload_fd, POLLIN, 0};
+        int ready = poll(&fd, 1, changed_count ? HOT_RELOAD_SETTLE_MS : HOT_RELOAD_POLL_MS);
+        if (ready > 0) {
+            ssize_t len;
+            while ((len = read(reload_fd, events, sizeof(events))) > 0) {
+                for (char* p = events; p < events + len;) {
+                    const struct inotify_event* event = (const struct inotify_event*)p;
+                    p += sizeof(struct inotify_event) + event->len;
+                    if (!event->len) continue;
+                    SDL_LockMutex(reload_lock);
+                    for (int i = 0; i < sourceCount; i++) {
+                        if (Sources[i].wd != event->wd || strcmp(Sources[i].name, event->name) != 0) continue;
+                        int seen = 0;
+                        for (int k = 0; k < changed_count; k++) seen |= changed[k] == i;
+                        if (seen) continue;
+                        if (changed_count == changed_limit) {
+                            changed_limit = changed_limit ? changed_limit * 2 : BLUEPRINT_INIT;
+                            changed = slRealloc(changed, changed_limit * sizeof(int));
+                        }
+                        changed[changed_count++] = i;
+                    }
+                    SDL_UnlockMutex(reload_lock);
+                }
+            }
+            continue;
+        }
+        if (ready < 0 || changed_count == 0) continue;
+
+        // Quiet for a bit, parse everything that changed and hand it over
+        for (int k = 0; k < changed_count; k++) {
+            SDL_LockMutex(reload_lock);
+            int kind = Sources[changed[k]].kind;
+            const char* path = Sources[changed[k]].path;
+            SDL_UnlockMutex(reload_lock);
+
+            SL_ReloadResult* result = hotReloadParse(changed[k], kind, path);
+            SDL_LockMutex(reload_lock);
+            result->next = reload_results;
+            reload_results = result;
+            SDL_UnlockMutex(reload_lock);
+        }
+        changed_count = 0;
+        SDL_AtomicSet(&reload_ready, 1);
+    }
+    free(changed);
+    return 0;
+}
+#else
+static void hotReloadWatch(SL_SourceFile* source) {
+    (void)source;
+}
+#endif
+
+int SL_EnableHotReload(void) {
+#ifdef SL_HOT_RELOAD
+    if (reload_thread) return 0;
+    if ((global_flags & SL_FLAGS_MANAGE_MEMORY) != SL_FLAGS_MANAGE_MEMORY) {
+        SDL_SetError("Hot reload needs SL_FLAGS_MANAGE_MEMORY");
+        return -1;
+    }
+    reload_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (reload_fd < 0) {
+        SDL_SetError("Couldn't start inotify");
+        return -1;
+    }
+    reload_lock = SDL_CreateMutex();
+    for (int i = 0; i < sourceCount; i++) {
+        hotReloadWatch(&Sources[i]);
+    }
+    SDL_AtomicSet(&reload_quit, 0);
+    SDL_AtomicSet(&reload_ready, 0);
+    reload_thread = SDL_CreateThread(hotReloadThread, "SliggyHotReload", NULL);
+    if (!reload_thread) {
+        SL_DisableHotReload();
+        return -1;
+    }
+    return 0;
+#else
+    SDL_SetError("Hot reload needs inotify, so it's Linux only for now");
+    return -1;
+#endif
+}
+
+void SL_DisableHotReload(void) {
+#ifdef SL_HOT_RELOAD
+    if (reload_thread) {
+        SDL_AtomicSet(&reload_quit, 1);
+        SDL_WaitThread(reload_thread, NULL);
+        reload_thread = NULL;
+    }
+    if (reload_fd >= 0) {
+        close(reload_fd);
+        reload_fd = -1;
+    }
+    for (int i = 0; i < sourceCount; i++) {
+        Sources[i].wd = -1;
+    }
+    while (reload_results) {
+        SL_ReloadResult* next = reload_results->next;
+        reloadResultFree(reload_results);
+        reload_results = next;
+    }
+    if (reload_lock) {
+        SDL_DestroyMutex(reload_lock);
+        reload_lock = NULL;
+    }
+#endif
+}
+
+static void reloadResultFree(SL_ReloadResult* result) {
+    releaseFont(&result->font);
+    blueprintOutputFree(&result->blueprint);
+    free(result->compiled);
+    free(result);
+}
+
+// Text keeps indices into the glyph table, point them at the same codepoints in the new one
+static void remapTextGlyphs(SL_TextObject* t, const SL_Font* from, const SL_Font* to) {
+    for (int i = 0; i < t->length; i++) {
+        int idx = t->glyphs[i];
+        if (idx >= from->table.blank) {
+            t->glyphs[i] = (uint16_t)(to->table.blank + (idx - from->table.blank));
+        }
+        else {
+            t->glyphs[i] = glyphSlot(to, from->table.codepoints[idx]);
+        }
+    }
+}
+
+// The font keeps its address, references and texture, everything loaded from the file is replaced
+static void reloadFont(const SL_SourceFile* source, SL_Font* fresh) {
+    SL_Id id = findId(source->path);
+    int idx = id != SL_NO_ID && fontLimit ? nameIndexFind(&FontMap, intern_names[id], intern_hashes[id]) : -1;
+    if (idx < 0) {
+        // Released since it was loaded
+        releaseFont(fresh);
+        return;
+    }
+    SL_Font* font = Fonts[idx];
+    for (int i = 0; i < elementCount; i++) {
+        SL_UIElement* element = elementAt(i);
+        for (int k = 0; k < element->textCount; k++) {
+            if (element->TextObjects[k].font == font) {
+                unshareText(&element->TextObjects[k]);
+                remapTextGlyphs(&element->TextObjects[k], font, fresh);
+            }
+        }
+    }
+    // Nothing's on the font's runs any more, and they'd never match the new generation
+    shapePurgeFont(font);
+
+    SL_Font old = *font;
+    *font = *fresh;
+    memset(fresh, 0, sizeof(SL_Font));
+    font->path = old.path;
+    font->refs = old.refs;
+    font->generation = old.generation + 1;
+    font->texture = old.texture;
+    // The field came from the atlas, not the file
+    font->sdf = old.sdf;
+    font->sdf_width = old.sdf_width;
+    font->sdf_height = old.sdf_height;
+    font->sdf_sizes = old.sdf_sizes;
+    font->sdf_size_count = old.sdf_size_count;
+    old.sdf = NULL;
+    old.sdf_sizes = NULL;
+    old.sdf_size_count = 0;
+    if (font->sdf) {
+        sdfRefresh(font);
+    }
+    if (old.kerning_keys && !old.kerning_enabled) {
+        font->kerning_enabled = 0;
+    }
+    if (old.atlas_region.w > 0) {
+        remapFont(font, old.texture, old.atlas_region, old.atlas_page_w, old.atlas_page_h);
+    }
+    releaseFont(&old);
+}
+
+static void reloadBlueprint(const SL_SourceFile* source, SL_ReloadResult* result) {
+    SL_BlueprintState state;
+    memset(&state, 0, sizeof(state));
+    state.path = source->path;
+    state.loader = source->loader;
+    state.userdata = source->userdata;
+    state.reload = 1;
+    int ok;
+    if (result->compiled) {
+        ok = loadBlueprintBinary(&state, result->compiled, result->compiled_size);
+    }
+    else {
+        const SL_BlueprintOutput* out = &result->blueprint;
+        state.strings = out->strings;
+        ok = walkBlueprint(&state, out->resources, out->resource_count, out->elements, out->element_count, out->texts);
+    }
+    if (ok != 0) {
+        SDL_Log("Sliggy: couldn't reload %s: %s", source->path, SDL_GetError());
+    }
+    blueprintStateFree(&state);
+}
+
+// The loader decides whether that's a new texture or the old one updated, either way everything using it is redrawn
+static void reloadTexture(SL_SourceFile* source) {
+    SDL_Texture* old = source->texture;
+    SDL_Texture* texture = source->loader ? source->loader(source->path, source->userdata) : NULL;
+    if (!texture) {
+        SDL_Log("Sliggy: couldn't reload %s: %s", source->path, SDL_GetError());
+        return;
+    }
+    source->texture = texture;
+    SL_Damage(NULL);
+    if (texture == old) return;
+
+    int tex_w;
+    int tex_h;
+    SDL_QueryTexture(texture, NULL, NULL, &tex_w, &tex_h);
+    for (int i = 0; i < elementCount; i++) {
+        SL_UIElement* element = elementAt(i);
+        if (!(element->flags & SL_INNERFLAG_IN_USE) || element->texture_skin != old) continue;
+        // Same part of the texture as before, in the new texture's pixels
+        const float* uv = element->skin_uv;
+        int whole = uv[0] == 0.0f && uv[1] == 0.0f && uv[2] == 1.0f && uv[3] == 1.0f;
+        SDL_Rect region = {
+                (int)(uv[0] * (float)tex_w + 0.5f),
+                (int)(uv[1] * (float)tex_h + 0.5f),
+                (int)((uv[2] - uv[0]) * (float)tex_w + 0.5f),
+                (int)((uv[3] - uv[1]) * (float)tex_h + 0.5f)
+        };
+        SL_SetSkinRegion(element, texture, whole ? NULL : &region);
+    }
+    for (int i = 0; i < fontCount; i++) {
+        if (Fonts[i] && Fonts[i]->texture == old) {
+            Fonts[i]->texture = texture;
+        }
+    }
+}
+
+// Called from SL_BeginFrame, so nothing changes under a frame that's being drawn
+static void hotReloadApply(void) {
+    SDL_LockMutex(reload_lock);
+    SL_ReloadResult* results = reload_results;
+    reload_results = NULL;
+    SDL_AtomicSet(&reload_ready, 0);
+    SDL_UnlockMutex(reload_lock);
+
+    // Newest first, put them back in the order they were saved
+    SL_ReloadResult* ordered = NULL;
+    while (results) {
+        SL_ReloadResult* next = results->next;
+        results->next = ordered;
+        ordered = results;
+        results = next;
+    }
+    while (ordered) {
+        SL_ReloadResult* result = ordered;
+        ordered = result->next;
+        SL_SourceFile* source = &Sources[result->source];
+        if (!result->ok) {
+            SDL_Log("Sliggy: couldn't reload %s: %s", source->path, result->error);
+        }
+        else if (source->kind == SOURCE_FONT) {
+            reloadFont(source, &result->font);
+        }
+        else if (source->kind == SOURCE_BLUEPRINT) {
+            reloadBlueprint(source, result);
+        }
+        else {
+            reloadTexture(source);
+        }
+        reloadResultFree(result);
+    }
+}
+
+/*
+ * Decodes one codepoint and advances str past it. Malformed sequences come back as U+FFFD and consume
+ * a single byte, so a bad string still terminates.
+ */
+static uint32_t decodeUtf8(const unsigned char** str) {
+    const unsigned char* s = *str;
+    uint32_t cp;
+    int extra;
+    if (s[0] < 0x80) {
+        *str = s + 1;
+        return s[0];
+    }
+    else if ((s[0] & 0xE0) == 0xC0) {
+        cp = s[0] & 0x1F;
+        extra = 1;
+    }
+    else if ((s[0] & 0xF0) == 0xE0) {
+        cp = s[0] & 0x0F;
+        extra = 2;
+    }
+    else if ((s[0] & 0xF8) == 0xF0) {
+        cp = s[0] & 0x07;
+        extra = 3;
+    }
+    else {
+        *str = s + 1;
+        return UTF8_REPLACEMENT;
+    }
+    for (int i = 1; i <= extra; i++) {
+        if ((s[i] & 0xC0) != 0x80) {
+            *str = s + 1;
+            return UTF8_REPLACEMENT;
+        }
+        cp = (cp << 6) | (s[i] & 0x3F);
+    }
+    // Overlong encodings and surrogates
+    static const uint32_t min_cp[4] = {0, 0x80, 0x800, 0x10000};
+    if (cp < min_cp[extra] || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) {
+        *str = s + 1;
+        return UTF8_REPLACEMENT;
+    }
+    *str = s + extra + 1;
+    return cp;
+}
+
+static SL_UIElement* elementAt(int idx) {
+    return &ElementPages[idx / ELEMENT_PAGE_SIZE][idx % ELEMENT_PAGE_SIZE];
+}
+
+// FNV-1a
+static uint32_t hashName(const char* name) {
+    uint32_t hash = 2166136261u;
+    for (const unsigned char* c = (const unsigned char*) name; *c != '\0'; c++) {
+        hash ^= *c;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static int slotOccupied(const SL_NameIndex* map, int slot) {
+    return (map->occupied[slot >> 5] >> (slot & 31)) & 1;
+}
+
+static void nameIndexInit(SL_NameIndex* map, int limit) {
+    // Power of two so probing can mask instead of mod
+    int l = 1;
+    while (l < limit) l <<= 1;
+    map->limit = l;
+    map->count = 0;
+    map->hashes = slMalloc(l * sizeof(uint32_t));
+    map->keys = slMalloc(l * sizeof(const char*));
+    map->values = slMalloc(l * sizeof(int));
+    map->occupied = slCalloc((l + 31) / 32, sizeof(uint32_t));
+}
+
+static size_t nameIndexBytes(const SL_NameIndex* map) {
+    return map->limit * (sizeof(uint32_t) + sizeof(const char*) + sizeof(int)) + ((map->limit + 31) / 32) * sizeof(uint32_t);
+}
+
+// Empties the map but keeps its size
+static void nameIndexClear(SL_NameIndex* map) {
+    memset(map->occupied, 0, ((map->limit + 31) / 32) * sizeof(uint32_t));
+    map->count = 0;
+}
+
+static void nameIndexFree(SL_NameIndex* map) {
+    free(map->hashes);
+    free(map->keys);
+    free(map->values);
+    free(map->occupied);
+    map->hashes = NULL;
+    map->keys = NULL;
+    map->values = NULL;
+    map->occupied = NULL;
+    map->limit = 0;
+    map->count = 0;
+}
+
+// Returns the slot holding name, or the empty slot where it would go
+static int nameIndexProbe(const SL_NameIndex* map, const char* name, uint32_t hash) {
+    int mask = map->limit - 1;
+    int slot = (int)(hash & mask);
+    while (slotOccupied(map, slot)) {
+        if (map->hashes[slot] == hash && (map->keys[slot] == name || strcmp(map->keys[slot], name) == 0)) {
+            break;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+static void nameIndexGrow(SL_NameIndex* map) {
+    SL_NameIndex old = *map;
+    nameIndexInit(map, old.limit * 2);
+    int mask = map->limit - 1;
+    for (int i = 0; i < old.limit; i++) {
+        if (!slotOccupied(&old, i)) continue;
+        // Keys are unique already, so just find the first free slot
+        int slot = (int)(old.hashes[i] & mask);
+        while (slotOccupied(map, slot)) {
+            slot = (slot + 1) & mask;
+        }
+        map->hashes[slot] = old.hashes[i];
+        map->keys[slot] = old.keys[i];
+        map->values[slot] = old.values[i];
+        map->occupied[slot >> 5] |= 1u << (slot & 31);
+    }
+    map->count = old.count;
+    nameIndexFree(&old);
+}
+
+static int nameIndexFind(const SL_NameIndex* map, const char* name, uint32_t hash) {
+    if (!map || map->limit == 0 || !name) return -1;
+    int slot = nameIndexProbe(map, name, hash);
+    return slotOccupied(map, slot) ? map->values[slot] : -1;
+}
+
+// Inserting a name that's already present replaces its value
+static void nameIndexInsert(SL_NameIndex* map, const char* name, uint32_t hash, int value) {
+    if ((float)(map->count + 1) > (float)map->limit * MAP_MAX_LOAD) {
+        nameIndexGrow(map);
+    }
+    int slot = nameIndexProbe(map, name, hash);
+    if (!slotOccupied(map, slot)) {
+        map->occupied[slot >> 5] |= 1u << (slot & 31);
+        map->hashes[slot] = hash;
+        map->keys[slot] = name;
+        map->count++;
+    }
+    map->values[slot] = value;
+}
+
+// Backward shift deletion - no tombstones, so misses still stop at the first empty slot
+static void nameIndexRemove(SL_NameIndex* map, const char* name, uint32_t hash) {
+    if (!map || map->limit == 0) return;
+    int mask = map->limit - 1;
+    int slot = nameIndexProbe(map, name, hash);
+    if (!slotOccupied(map, slot)) return;
+
+    int next = (slot + 1) & mask;
+    while (slotOccupied(map, next)) {
+        int home = (int)(map->hashes[next] & mask);
+        // Move next back into the hole unless its home lies cyclically in (slot, next]
+        if (((next - home) & mask) >= ((next - slot) & mask)) {
+            map->hashes[slot] = map->hashes[next];
+            map->keys[slot] = map->keys[next];
+            map->values[slot] = map->values[next];
+            slot = next;
+        }
+        next = (next + 1) & mask;
+    }
+    map->occupied[slot >> 5] &= ~(1u << (slot & 31));
+    map->count--;
+}
+
+SL_UIElement* getElementFromMap(const char* name) {
+    return SL_GetElementById(findId(name));
+}
+
+SL_UIElement* SL_GetElementById(SL_Id id) {
+    if (id == SL_NO_ID || (int)id >= elementByIdLimit) return NULL;
+    int idx = ElementById[id];
+    return idx < 0 ? NULL : elementAt(idx);
+}
+
+static SL_TextObject* findTextObject(const SL_UIElement* element, SL_Id id) {
+    if (id == SL_NO_ID) return NULL;
+    int idx = nameIndexFind(element->TextObjectMap, intern_names[id], intern_hashes[id]);
+    return idx < 0 ? NULL : &element->TextObjects[idx];
+}
+
+// Interning
+
+// Id 0 is reserved for SL_NO_ID
+static void internInit(void) {
+    nameIndexInit(&InternMap, INTERN_INIT);
+    intern_limit = INTERN_INIT;
+    intern_names = slMalloc(intern_limit * sizeof(const char*));
+    intern_hashes = slMalloc(intern_limit * sizeof(uint32_t));
+    intern_names[0] = NULL;
+    intern_hashes[0] = 0;
+    intern_count = 1;
+}
+
+static void internQuit(void) {
+    nameIndexFree(&InternMap);
+    free(intern_names);
+    free(intern_hashes);
+    for (int i = 0; i < intern_page_count; i++) {
+        free(intern_pages[i]);
+    }
+    free(intern_pages);
+    intern_names = NULL;
+    intern_hashes = NULL;
+    intern_pages = NULL;
+    intern_count = 0;
+    intern_limit = 0;
+    intern_page_count = 0;
+    intern_page_used = INTERN_PAGE_SIZE;
+}
+
+// Strings are packed into pages so interning doesn't malloc per name
+static const char* internCopy(const char* name, size_t len) {
+    if (len + 1 > INTERN_PAGE_SIZE - intern_page_used) {
+        size_t size = len + 1 > INTERN_PAGE_SIZE ? len + 1 : INTERN_PAGE_SIZE;
+        intern_pages = slRealloc(intern_pages, (intern_page_count + 1) * sizeof(char*));
+        intern_pages[intern_page_count++] = slMalloc(size);
+        intern_page_used = 0;
+        // An oversized name gets a page to itself, the next one starts fresh
+        if (size > INTERN_PAGE_SIZE) {
+            memcpy(intern_pages[intern_page_count - 1], name, len + 1);
+            intern_page_used = INTERN_PAGE_SIZE;
+            return intern_pages[intern_page_count - 1];
+        }
+    }
+    char* dst = intern_pages[intern_page_count - 1] + intern_page_used;
+    memcpy(dst, name, len + 1);
+    intern_page_used += len + 1;
+    return dst;
+}
+
+static SL_Id findId(const char* name) {
+    if (!name || intern_count == 0) return SL_NO_ID;
+    int id = nameIndexFind(&InternMap, name, hashName(name));
+    return id < 0 ? SL_NO_ID : (SL_Id)id;
+}
+
+SL_Id SL_Intern(const char* name) {
+    if (!name) return SL_NO_ID;
+    if (intern_count == 0) {
+        internInit();
+    }
+    uint32_t hash = hashName(name);
+    int id = nameIndexFind(&InternMap, name, hash);
+    if (id >= 0) return (SL_Id)id;
+
+    if (intern_count == intern_limit) {
+        intern_limit *= 2;
+        intern_names = slRealloc(intern_names, intern_limit * sizeof(const char*));
+        intern_hashes = slRealloc(intern_hashes, intern_limit * sizeof(uint32_t));
+    }
+    id = intern_count++;
+    intern_names[id] = internCopy(name, strlen(name));
+    intern_hashes[id] = hash;
+    nameIndexInsert(&InternMap, intern_names[id], hash, id);
+    return (SL_Id)id;
+}
+
+const char* SL_IdName(SL_Id id) {
+    if (id == SL_NO_ID || (int)id >= intern_count) return NULL;
+    return intern_names[id];
+}
+
+SL_Id SL_GetElementId(const SL_UIElement* element) {
+    return element ? element->id : SL_NO_ID;
+}
+
+void SL_DrawElement(const SL_UIElement* element) {
+
+    if (!SL_ElementIsActive(element)) return;
+
+    SDL_Vertex* vertices;
+    int* skin_idxs;
+    int base = batchReserve(NUM_VERTICES, NUM_INDICES, &vertices, &skin_idxs);
+    if (base < 0) return;
+    int first_index = batch_index_count - NUM_INDICES;
+
+    memcpy(vertices, element->skin_vertices, sizeof(element->skin_vertices));
+    for (int i = 0; i < NUM_INDICES; i++) {
+        skin_idxs[i] = indices[i] + base;
+    }
+    batchPushCommand(element->texture_skin, first_index, NUM_INDICES, element->src_rect);
+
+    for (int k = 0; k < element->textCount; k++) {
+        SL_TextObject* t = &element->TextObjects[k];
+        if (t->visible == 0) continue;
+
+        PrepareText(t, element);
+        drawText(t);
+    }
+    if (element->list) {
+        updateList(element);
+    }
+
+    frame_stats.elements++;
+
+    // Outside of SL_BeginFrame/SL_EndFrame every element is its own frame
+    if (!in_frame) {
+        batchFlush();
+    }
+}
+
+// The 16 corners of the 9-slice, rows top to bottom
+static void BakeSkin(SL_UIElement* element) {
     int start_x = element->src_rect.x;
     int start_y = element->src_rect.y;
     int width = element->src_rect.w;
     int height = element->src_rect.h;
-    SDL_Vertex vertices[NUM_VERTICES];
 
-    for (int y = 0; y < 4; y++) {
-        int step_y;
-        switch (y) {
-            default: step_y = 0; break;
-            case 1: step_y = element->skin_step_y; break;
-            case 2: step_y = height - element->skin_step_y; break;
-            case 3: step_y = height; break;
+    for (int y = 0; y < 4; y++) {
+        int step_y;
+        switch (y) {
+            default: step_y = 0; break;
+            case 1: step_y = element->skin_step_y; break;
+            case 2: step_y = height - element->skin_step_y; break;
+            case 3: step_y = height; break;
+        }
+        for (int x = 0; x < 4; x++) {
+            int step_x;
+            switch (x) {
+                default: step_x = 0; break;
+                case 1: step_x = element->skin_step_x; break;
+                case 2: step_x = width - element->skin_step_x; break;
+                case 3: step_x = width; break;
+            }
+            int rx = start_x + step_x;
+            int ry = start_y + step_y;
+            float uvx = element->skin_uv[0] + (element->skin_uv[2] - element->skin_uv[0]) * (float)x / 3.0f;
+            float uvy = element->skin_uv[1] + (element->skin_uv[3] - element->skin_uv[1]) * (float)y / 3.0f;
+
+            int idx = (y * 4) + x;
+            SDL_Vertex v = {
+                {(float)rx, (float)ry},
+                element->tint,
+                {uvx, uvy},
+            };
+            element->skin_vertices[idx] = v;
+        }
+    }
+}
+
+// Region NULL means the whole texture. Leaves the vertices for BakeSkin
+static void applySkin(SL_UIElement* element, SDL_Texture* skin, const SDL_Rect* region) {
+    element->texture_skin = skin;
+    element->skin_step_x = 0;
+    element->skin_step_y = 0;
+    element->skin_uv[0] = 0.0f;
+    element->skin_uv[1] = 0.0f;
+    element->skin_uv[2] = 1.0f;
+    element->skin_uv[3] = 1.0f;
+    if (!skin) return;
+
+    // TODO error handle
+    int tex_w;
+    int tex_h;
+    SDL_QueryTexture(skin, NULL, NULL, &tex_w, &tex_h);
+    SDL_Rect r = region ? *region : (SDL_Rect){0, 0, tex_w, tex_h};
+    element->skin_step_x = r.w / 3;
+    element->skin_step_y = r.h / 3;
+    if (region && tex_w > 0 && tex_h > 0) {
+        element->skin_uv[0] = (float)r.x / (float)tex_w;
+        element->skin_uv[1] = (float)r.y / (float)tex_h;
+        element->skin_uv[2] = (float)(r.x + r.w) / (float)tex_w;
+        element->skin_uv[3] = (float)(r.y + r.h) / (float)tex_h;
+    }
+}
+
+static void TintSkin(SL_UIElement* element) {
+    for (int i = 0; i < NUM_VERTICES; i++) {
+        element->skin_vertices[i].color = element->tint;
+    }
+}
+
+static SDL_Color modulateColor(SDL_Color c, SDL_Color tint) {
+    SDL_Color out = {
+            (Uint8)(c.r * tint.r / 255),
+            (Uint8)(c.g * tint.g / 255),
+            (Uint8)(c.b * tint.b / 255),
+            (Uint8)(c.a * tint.a / 255)
+    };
+    return out;
+}
+
+// Copies a prepared text's quads into the batch. Text longer than what's left of the arena goes out over several
+// flushes, and a partly revealed text is just a shorter prefix of the same quads
+// Distance field text draws from the texture for its size, everything else from the font's
+static SDL_Texture* textTexture(const SL_TextObject* t) {
+    return t->sdf_size >= 0 ? t->font->sdf_sizes[t->sdf_size].texture : t->font->texture;
+}
+
+static const float* textUvs(const SL_TextObject* t) {
+    return t->sdf_size >= 0 ? t->font->sdf_sizes[t->sdf_size].uvs : t->font->table.uvs;
+}
+
+static void drawText(SL_TextObject* t) {
+    int count;
+    for (int first = 0; first < t->visible; first += count) {
+        count = batchQuadsAvailable(t->visible - first);
+        int num_text_vertices = count * 4;
+        int num_text_indices = count * 6;
+
+        SDL_Vertex* text_vertices;
+        int* idxs;
+        int text_base = batchReserve(num_text_vertices, num_text_indices, &text_vertices, &idxs);
+        int text_first_index = batch_index_count - num_text_indices;
+
+        memcpy(text_vertices, t->vertices + first * 4, num_text_vertices * sizeof(SDL_Vertex));
+        const int* src = t->indices + first * 6;
+        int offset = text_base - first * 4;
+        for (int i = 0; i < num_text_indices; i++) {
+            idxs[i] = src[i] + offset;
+        }
+        batchPushCommand(textTexture(t), text_first_index, num_text_indices, t->bounds);
+    }
+}
+
+void SL_DrawElementById(SL_Id id) {
+    SL_DrawElement(SL_GetElementById(id));
+}
+
+void SL_BeginFrame(void) {
+    if (reload_thread && SDL_AtomicGet(&reload_ready)) {
+        hotReloadApply();
+    }
+    if (in_frame) {
+        batchFlush();
+    }
+    in_frame = 1;
+    batch_vertex_count = 0;
+    batch_index_count = 0;
+    batch_command_count = 0;
+    memset(&frame_stats, 0, sizeof(SL_FrameStats));
+    SDL_AtomicSet(&allocation_count, 0);
+}
+
+void SL_EndFrame(void) {
+    batchFlush();
+    in_frame = 0;
+}
+
+SL_FrameStats SL_GetFrameStats(void) {
+    SL_FrameStats stats = frame_stats;
+    stats.allocations = SDL_AtomicGet(&allocation_count);
+    return stats;
+}
+
+int SL_SetRetained(int enabled) {
+    if (!enabled) {
+        if (retained_layer) {
+            SDL_DestroyTexture(retained_layer);
+            retained_layer = NULL;
+        }
+        damage_count = 0;
+        return 0;
+    }
+    if (retained_layer) return 0;
+    if ((global_flags & SL_FLAGS_MANAGE_MEMORY) != SL_FLAGS_MANAGE_MEMORY) {
+        SDL_SetError("Retained mode needs SL_FLAGS_MANAGE_MEMORY");
+        return -1;
+    }
+    retained_layer = SDL_CreateTexture(render_context, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET,
+                                       screen_width, screen_height);
+    if (!retained_layer) return -1;
+
+    // The layer holds premultiplied colour (drawn with normal blending onto transparent black),
+    // so it's composited with ONE instead of SRC_ALPHA where the renderer allows it
+    SDL_BlendMode premultiplied = SDL_ComposeCustomBlendMode(
+            SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD,
+            SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD);
+    if (SDL_SetTextureBlendMode(retained_layer, premultiplied) != 0) {
+        SDL_SetTextureBlendMode(retained_layer, SDL_BLENDMODE_BLEND);
+    }
+    SL_Damage(NULL);
+    return 0;
+}
+
+void SL_Damage(const SDL_Rect* rect) {
+    if (!retained_layer) return;
+    SDL_Rect everything = {0, 0, screen_width, screen_height};
+    damageRect(rect ? *rect : everything);
+}
+
+static void damageRect(SDL_Rect rect) {
+    SDL_Rect screen = {0, 0, screen_width, screen_height};
+    if (!SDL_IntersectRect(&rect, &screen, &rect)) return;
+    // Overlapping damage is merged so nothing gets redrawn twice
+    for (int i = 0; i < damage_count; i++) {
+        if (SDL_HasIntersection(&damage[i], &rect)) {
+            SDL_UnionRect(&damage[i], &rect, &rect);
+            damage[i] = damage[--damage_count];
+            i = -1;
+        }
+    }
+    if (damage_count == DAMAGE_MAX_RECTS) {
+        for (int i = 0; i < damage_count; i++) {
+            SDL_UnionRect(&damage[i], &rect, &rect);
+        }
+        damage_count = 0;
+    }
+    damage[damage_count++] = rect;
+}
+
+// Where the element is on the layer right now - skin plus whatever text was last built, which can spill out
+static SDL_Rect elementBounds(const SL_UIElement* element) {
+    SDL_Rect bounds = element->src_rect;
+    for (int k = 0; k < element->textCount; k++) {
+        const SL_TextObject* t = &element->TextObjects[k];
+        if (t->vertices && t->length > 0) {
+            SDL_UnionRect(&bounds, &t->bounds, &bounds);
+        }
+    }
+    return bounds;
+}
+
+// Call before changing the element - the old area is damaged now, the new one when the layer is next drawn
+static void damageElement(SL_UIElement* element) {
+    if (!retained_layer) return;
+    if (SL_ElementIsActive(element) && !(element->flags & SL_INNERFLAG_DAMAGED)) {
+        damageRect(elementBounds(element));
+    }
+    element->flags |= SL_INNERFLAG_DAMAGED;
+}
+
+void SL_DrawRetained(void) {
+    if (!retained_layer) return;
+
+    // Changed elements damage where they are now as well, which needs their text built - on the job pool if
+    // there is one. A font changing under a text (kerning, reload) counts as a change
+    int jobs = 0;
+    for (int i = 0; i < elementCount; i++) {
+        SL_UIElement* element = elementAt(i);
+        if (!SL_ElementIsActive(element)) {
+            element->flags &= ~SL_INNERFLAG_DAMAGED;
+            continue;
+        }
+        for (int k = 0; k < element->textCount; k++) {
+            if (element->TextObjects[k].font_generation != element->TextObjects[k].font->generation) {
+                damageElement(element);
+            }
+        }
+        if ((element->flags & SL_INNERFLAG_DAMAGED) && element->textCount > 0) {
+            reserveJobElements(jobs + 1);
+            job_elements[jobs++] = element;
+        }
+    }
+    runElementJobs(jobs);
+    for (int i = 0; i < elementCount; i++) {
+        SL_UIElement* element = elementAt(i);
+        if (element->flags & SL_INNERFLAG_DAMAGED) {
+            damageRect(elementBounds(element));
+            element->flags &= ~SL_INNERFLAG_DAMAGED;
+        }
+    }
+
+    if (damage_count > 0) {
+        // Anything already queued belongs on the current target
+        batchFlush();
+        int was_in_frame = in_frame;
+        in_frame = 1;
+
+        SDL_Texture* target = SDL_GetRenderTarget(render_context);
+        Uint8 r, g, b, a;
+        SDL_BlendMode blend;
+        SDL_GetRenderDrawColor(render_context, &r, &g, &b, &a);
+        SDL_GetRenderDrawBlendMode(render_context, &blend);
+        SDL_SetRenderTarget(render_context, retained_layer);
+        SDL_SetRenderDrawColor(render_context, 0, 0, 0, 0);
+        SDL_SetRenderDrawBlendMode(render_context, SDL_BLENDMODE_NONE);
+
+        for (int d = 0; d < damage_count; d++) {
+            SDL_RenderSetClipRect(render_context, &damage[d]);
+            SDL_RenderFillRect(render_context, &damage[d]);
+            // Creation order, not slot order - a freed slot can be handed to something that should be on top
+            for (int i = 0; i < drawOrderCount; i++) {
+                if (DrawOrder[i] < 0) continue;
+                SL_UIElement* element = elementAt(DrawOrder[i]);
+                if (!SL_ElementIsActive(element)) continue;
+                SDL_Rect bounds = elementBounds(element);
+                if (SDL_HasIntersection(&bounds, &damage[d])) {
+                    SL_DrawElement(element);
+                }
+            }
+            batchFlush();
+        }
+        frame_stats.damage_rects += damage_count;
+        damage_count = 0;
+
+        SDL_RenderSetClipRect(render_context, NULL);
+        SDL_SetRenderTarget(render_context, target);
+        SDL_SetRenderDrawColor(render_context, r, g, b, a);
+        SDL_SetRenderDrawBlendMode(render_context, blend);
+        in_frame = was_in_frame;
+    }
+
+    SDL_RenderCopy(render_context, retained_layer, NULL, NULL);
+}
+
+void SL_SetFrameArenaCapacity(int bytes) {
+    // Whatever is queued lives in the old block
+    batchFlush();
+    frameArenaFree();
+    frame_arena_capacity = bytes;
+    frame_arena_high_water = 0;
+}
+
+int SL_GetFrameArenaHighWater(void) {
+    return frame_arena_high_water;
+}
+
+static size_t fontBytes(const SL_Font* font) {
+    size_t bytes = sizeof(SL_Font);
+    if (font->mapping) {
+        bytes += font->mapping_size;
+    }
+    else {
+        bytes += font->count * sizeof(SL_Glyph) + font->kerning_count * sizeof(SL_Kerning);
+    }
+    bytes += (font->count + 2) * (8 * sizeof(float) + sizeof(uint32_t) + 2);
+    if (font->page_index) {
+        bytes += FONT_PAGE_COUNT * sizeof(uint16_t) + font->page_count * (1 << FONT_PAGE_SHIFT) * sizeof(uint16_t);
+    }
+    if (font->kerning_keys) {
+        bytes += (font->kerning_mask + 1) * (sizeof(uint64_t) + sizeof(int16_t));
+    }
+    bytes += (size_t)font->sdf_width * font->sdf_height + font->sdf_size_count * sizeof(SL_SdfSize);
+    for (int i = 0; i < font->sdf_size_count; i++) {
+        if (font->sdf_sizes[i].uvs) bytes += (font->count + 2) * 4 * sizeof(float);
+    }
+    return bytes;
+}
+
+SL_MemoryStats SL_GetMemoryStats(void) {
+    SL_MemoryStats stats = memory_stats;
+
+    stats.elements += elementPageCount * (ELEMENT_PAGE_SIZE * sizeof(SL_UIElement) + sizeof(SL_UIElement*));
+    stats.elements += elementByIdLimit * sizeof(int);
+    stats.elements += drawOrderLimit * sizeof(int);
+
+    for (int i = 0; i < fontCount; i++) {
+        if (!Fonts[i]) continue;
+        stats.fonts += fontBytes(Fonts[i]);
+        for (int k = 0; k < Fonts[i]->sdf_size_count; k++) {
+            stats.textures += (size_t)Fonts[i]->sdf_sizes[k].width * Fonts[i]->sdf_sizes[k].height * 4;
+        }
+    }
+    if (fontLimit) {
+        stats.fonts += fontLimit * sizeof(SL_Font*) + nameIndexBytes(&FontMap);
+    }
+    stats.shapes = shape_stats.bytes + shape_bucket_count * sizeof(SL_ShapedRun*);
+
+    if (intern_limit) {
+        stats.names += intern_limit * (sizeof(const char*) + sizeof(uint32_t)) + nameIndexBytes(&InternMap);
+        stats.names += intern_page_count * (INTERN_PAGE_SIZE + sizeof(char*));
+    }
+
+    if (frame_arena) {
+        stats.frame = batch_command_limit * (sizeof(SL_DrawCommand) + sizeof(SL_Batch))
+                + batch_vertex_limit * sizeof(SDL_Vertex) + batch_index_limit * 2 * sizeof(int);
+    }
+    return stats;
+}
+
+/*
+ * Splits the arena between the batch buffers. Everything is sized off the vertex count - skins need
+ * ~3.4 indices per vertex and text 1.5, and a command can be as small as a single glyph.
+ */
+static int frameArenaInit(void) {
+    const int per_vertex = (int)(sizeof(SDL_Vertex) + 2 * 2 * sizeof(int)); // indices twice, for the flush copy
+    const int per_command = (int)(sizeof(SL_DrawCommand) + sizeof(SL_Batch));
+    int vertices = frame_arena_capacity / (per_vertex + per_command / 4);
+    if (vertices < FRAME_ARENA_MIN_VERTICES) vertices = FRAME_ARENA_MIN_VERTICES;
+
+    batch_vertex_limit = vertices;
+    batch_index_limit = vertices * 2;
+    batch_command_limit = vertices / 4;
+
+    size_t size = batch_command_limit * (sizeof(SL_DrawCommand) + sizeof(SL_Batch))
+            + batch_vertex_limit * sizeof(SDL_Vertex) + batch_index_limit * 2 * sizeof(int);
+    char* block = slMalloc(size);
+    if (!block) {
+        SDL_SetError("Couldn't allocate a %d byte frame arena", (int)size);
+        batch_vertex_limit = batch_index_limit = batch_command_limit = 0;
+        return -1;
+    }
+    // Most strictly aligned first
+    frame_arena = block;
+    batch_commands = (SL_DrawCommand*)block;
+    block += batch_command_limit * sizeof(SL_DrawCommand);
+    batches = (SL_Batch*)block;
+    block += batch_command_limit * sizeof(SL_Batch);
+    batch_vertices = (SDL_Vertex*)block;
+    block += batch_vertex_limit * sizeof(SDL_Vertex);
+    batch_indices = (int*)block;
+    block += batch_index_limit * sizeof(int);
+    flush_indices = (int*)block;
+    return 0;
+}
+
+static void frameArenaFree(void) {
+    free(frame_arena);
+    frame_arena = NULL;
+    batch_vertices = NULL;
+    batch_indices = NULL;
+    flush_indices = NULL;
+    batch_commands = NULL;
+    batches = NULL;
+    batch_vertex_limit = batch_index_limit = batch_command_limit = 0;
+}
+
+static int batchFits(int num_vertices, int num_indices) {
+    return batch_vertex_count + num_vertices <= batch_vertex_limit
+           && batch_index_count + num_indices <= batch_index_limit
+           && batch_command_count < batch_command_limit;
+}
+
+// How many of the wanted glyph quads can go in before a flush, flushing first if none can
+static int batchQuadsAvailable(int wanted) {
+    if (!frame_arena && frameArenaInit() != 0) return 0;
+    if (!batchFits(4, 6)) {
+        batchFlush();
+    }
+    int room = (batch_vertex_limit - batch_vertex_count) / 4;
+    int index_room = (batch_index_limit - batch_index_count) / 6;
+    if (index_room < room) room = index_room;
+    return wanted < room ? wanted : room;
+}
+
+/*
+ * Makes room for geometry at the end of the frame buffers and hands back where to write it, along with
+ * a slot for its command. Returns the index of the first reserved vertex so callers can offset their indices.
+ */
+static int batchReserve(int num_vertices, int num_indices, SDL_Vertex** vertices, int** idxs) {
+    if (!frame_arena && frameArenaInit() != 0) return -1;
+    if (!batchFits(num_vertices, num_indices)) {
+        batchFlush();
+    }
+    int base = batch_vertex_count;
+    *vertices = batch_vertices + batch_vertex_count;
+    *idxs = batch_indices + batch_index_count;
+    batch_vertex_count += num_vertices;
+    batch_index_count += num_indices;
+    return base;
+}
+
+// batchReserve has already made sure there's a slot
+static void batchPushCommand(SDL_Texture* texture, int first_index, int num_indices, SDL_Rect bounds) {
+    SL_DrawCommand cmd = {texture, first_index, num_indices, bounds, -1};
+    batch_commands[batch_command_count++] = cmd;
+}
+
+static int rectsOverlap(const SDL_Rect* a, const SDL_Rect* b) {
+    return a->x < b->x + b->w && b->x < a->x + a->w && a->y < b->y + b->h && b->y < a->y + a->h;
+}
+
+// The batch bounds are only a quick reject, a union of scattered panels covers most of the screen
+static int batchOverlaps(const SL_Batch* batch, const SDL_Rect* rect) {
+    if (!rectsOverlap(&batch->bounds, rect)) return 0;
+    int tests = 0;
+    for (int c = batch->head; c != -1; c = batch_commands[c].next) {
+        if (rectsOverlap(&batch_commands[c].bounds, rect) || ++tests > BATCH_MAX_RECT_TESTS) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Groups the queued commands by texture and submits each group with one SDL_RenderGeometry.
+ * A command may only move back into an earlier batch with the same texture if it doesn't overlap
+ * anything drawn in between, so the result still looks like painter's order.
+ */
+static void batchFlush(void) {
+    if (batch_command_count == 0) return;
+
+    int used = (int)(batch_vertex_count * sizeof(SDL_Vertex) + batch_index_count * sizeof(int)
+            + batch_command_count * sizeof(SL_DrawCommand));
+    if (used > frame_stats.arena_peak) frame_stats.arena_peak = used;
+    if (used > frame_arena_high_water) frame_arena_high_water = used;
+
+    int num_batches = 0;
+    for (int i = 0; i < batch_command_count; i++) {
+        SL_DrawCommand* cmd = &batch_commands[i];
+        int target = -1;
+        int stop = num_batches > BATCH_LOOKBACK ? num_batches - BATCH_LOOKBACK : 0;
+        for (int b = num_batches - 1; b >= stop; b--) {
+            if (batches[b].texture == cmd->texture) {
+                target = b;
+                break;
+            }
+            if (batchOverlaps(&batches[b], &cmd->bounds)) {
+                break;
+            }
+        }
+        if (target < 0) {
+            SL_Batch batch = {cmd->texture, cmd->bounds, i, i};
+            batches[num_batches++] = batch;
+        }
+        else {
+            SL_Batch* batch = &batches[target];
+            batch_commands[batch->tail].next = i;
+            batch->tail = i;
+            SDL_UnionRect(&batch->bounds, &cmd->bounds, &batch->bounds);
+        }
+    }
+
+    for (int b = 0; b < num_batches; b++) {
+        int count = 0;
+        for (int c = batches[b].head; c != -1; c = batch_commands[c].next) {
+            memcpy(flush_indices + count, batch_indices + batch_commands[c].first_index,
+                       batch_commands[c].num_indices * sizeof(int));
+            count += batch_commands[c].num_indices;
+        }
+        SDL_RenderGeometry(render_context, batches[b].texture, batch_vertices, batch_vertex_count, flush_indices, count);
+    }
+
+    frame_stats.draw_calls += num_batches;
+    frame_stats.commands += batch_command_count;
+    frame_stats.vertices += batch_vertex_count;
+    frame_stats.indices += batch_index_count;
+
+    batch_vertex_count = 0;
+    batch_index_count = 0;
+    batch_command_count = 0;
+}
+
+/*
+ * obj is either zeroed or parked from an earlier text, in which case its buffers are reused when they're big enough.
+ * width is the element's, for the shape cache to key the lines on. 0 keeps the text out of the cache
+ */
+static void InitTextObject(SL_TextObject* obj, SL_Font* font, const char *raw_text, float desired_size, int x_, int y_,
+                           int width) {
+    size_t old_bytes = textObjectBytes(obj);
+    SL_RetainFont(font);
+    obj->font = font;
+    // TODO set color
+    obj->c = Color_White;
+    obj->x_start = x_;
+    obj->y_start = y_;
+    obj->scale = desired_size / font->size;
+    obj->sdf_size = font->sdf ? sdfAcquire(font, obj->scale) : -1;
+    obj->length = 0;
+    obj->align = SL_TEXT_ALIGN_LEFT;
+    obj->num_lines = 0;
+    obj->layout_width = 0;
+    obj->layout_dirty = 1;
+    obj->font_generation = font->generation;
+    obj->dirty = 1;
+    obj->reveal_rate = 0;
+    obj->reveal_progress = 0;
+    obj->on_reveal = NULL;
+    obj->reveal_userdata = NULL;
+
+    // Decoded twice rather than over-allocating, text can stay resident for a long time
+    int length = utf8Length(raw_text);
+    int cached = width > 0 && shape_budget > 0 && length > 0 && length <= SHAPE_CACHE_MAX_GLYPHS;
+    uint32_t hash = cached ? hashName(raw_text) : 0;
+    SL_ShapedRun* run = cached ? shapeFind(font, obj->scale, width - x_, raw_text, hash) : NULL;
+    if (run) {
+        attachRun(obj, run, width);
+        obj->visible = obj->length;
+        memory_stats.text += textObjectBytes(obj) - old_bytes;
+        return;
+    }
+
+    obj->length = length;
+    reserveText(obj, obj->length);
+    const unsigned char* c = (const unsigned char*) raw_text;
+    for (int i = 0; i < obj->length; i++) {
+        uint32_t cp = *c < 0x80 ? *c++ : decodeUtf8(&c);
+        obj->glyphs[i] = glyphSlot(font, cp);
+    }
+    obj->visible = obj->length;
+    memory_stats.text += textObjectBytes(obj) - old_bytes;
+    if (cached) {
+        // Laid out now rather than on the job pool so the next text like it finds the lines ready
+        LayoutText(obj, width);
+        shapeAdd(obj, width - x_, raw_text, hash);
+    }
+}
+
+static int utf8Length(const char* str) {
+    int length = 0;
+    const unsigned char* c = (const unsigned char*) str;
+    while (*c != '\0') {
+        // ASCII skips the decoder entirely
+        if (*c < 0x80) c++;
+        else decodeUtf8(&c);
+        length++;
+    }
+    return length;
+}
+
+// Grows the glyph buffer to fit length glyphs, keeping what's in it. Doesn't touch the memory stats
+static void reserveText(SL_TextObject* t, int length) {
+    if (length <= t->capacity) return;
+    t->capacity = (length + TEXT_CAPACITY_STEP - 1) / TEXT_CAPACITY_STEP * TEXT_CAPACITY_STEP;
+    t->glyphs = slRealloc(t->glyphs, t->capacity * sizeof(uint16_t));
+    // Geometry gets sized to the new capacity the next time it's built
+    free(t->vertices);
+    free(t->indices);
+    t->vertices = NULL;
+    t->indices = NULL;
+    t->quad_capacity = 0;
+    t->dirty = 1;
+}
+
+// Heap bytes behind a text object, for SL_GetMemoryStats
+static size_t textObjectBytes(const SL_TextObject* t) {
+    return t->capacity * sizeof(uint16_t) + t->line_limit * sizeof(SL_TextLine)
+            + t->quad_capacity * (4 * sizeof(SDL_Vertex) + 6 * sizeof(int));
+}
+
+// Scaled width of the word starting at glyph i, up to the next space
+static int wordWidth(const SL_TextObject* t, int i) {
+    const uint32_t* codepoints = t->font->table.codepoints;
+    int width = 0;
+    for (; i < t->length && codepoints[t->glyphs[i]] != ' '; i++) {
+        width += (int)((float)glyphAdvance(t, i) * t->scale);
+    }
+    return width;
+}
+
+// Unscaled pen advance after glyph i, including any kerning against the glyph after it
+static int glyphAdvance(const SL_TextObject* t, int i) {
+    const SL_GlyphTable* table = &t->font->table;
+    int g = t->glyphs[i];
+    int advance = table->advances[g];
+    if ((table->flags[g] & SL_GLYPH_KERNS) && t->font->kerning_enabled && i + 1 < t->length) {
+        advance += kerningAmount(t->font, table->codepoints[g], table->codepoints[t->glyphs[i + 1]]);
+    }
+    return advance;
+}
+
+/*
+ * Breaks a text object into lines for its element's width. Lines are relative to the text's own origin,
+ * so moving the element or restyling the text never needs this again - only new text, metrics or width do.
+ */
+static void LayoutText(SL_TextObject* t, int width) {
+    unshareText(t);
+    t->num_lines = 0;
+    RelayoutText(t, width, 0, 0, 0);
+    t->dirty = 1;
+}
+
+/*
+ * Lays the text out again from line `from` on, keeping the lines before it. Once past glyph `settled` (the end
+ * of an edit), a line that breaks where the old one did means the rest are unchanged apart from being delta
+ * glyphs further along, so they're shifted instead. Returns the line after the last one that was redone.
+ */
+static int RelayoutText(SL_TextObject* t, int width, int from, int settled, int delta) {
+    int limit = width - t->x_start;
+    int line_step = (int)((float)t->font->line_height * t->scale);
+    int base = (int)((float)t->font->base * t->scale);
+    int old_lines = t->num_lines;
+    int redone = -1;
+
+    int textx = 0;
+    int line_y = from * line_step;
+    int line_start = from > 0 ? t->lines[from].start : 0;
+    int visible_width = 0;
+    const uint32_t* codepoints = t->font->table.codepoints;
+    t->num_lines = from;
+
+    for (int i = line_start; i <= t->length; i++) {
+        int end_of_text = i == t->length;
+        int line_break = 0;
+        if (!end_of_text) {
+            textx += (int)((float)glyphAdvance(t, i) * t->scale);
+            if (codepoints[t->glyphs[i]] == ' ') {
+                line_break = textx > limit || textx + wordWidth(t, i + 1) > limit;
+            }
+            else {
+                visible_width = textx;
+            }
+        }
+        // Even empty text gets a line so there's always a baseline to report
+        if (line_break || (end_of_text && (i > line_start || t->num_lines == 0))) {
+            int n = t->num_lines;
+            int synced = line_break && i >= settled && n + 1 < old_lines && t->lines[n].end + delta == i + 1;
+            if (n == t->line_limit) {
+                int old_limit = t->line_limit;
+                t->line_limit = t->line_limit ? t->line_limit * 2 : 4;
+                t->lines = slRealloc(t->lines, t->line_limit * sizeof(SL_TextLine));
+                textBytesChanged((long)((t->line_limit - old_limit) * sizeof(SL_TextLine)));
+            }
+            SL_TextLine line = {line_start, end_of_text ? i : i + 1, visible_width, line_y + base};
+            t->lines[t->num_lines++] = line;
+            if (synced) {
+                for (int l = n + 1; l < old_lines; l++) {
+                    t->lines[l].start += delta;
+                    t->lines[l].end += delta;
+                }
+                t->num_lines = old_lines;
+                redone = n + 1;
+                break;
+            }
+            line_start = i + 1;
+            textx = 0;
+            visible_width = 0;
+            line_y += line_step;
+        }
+    }
+
+    t->layout_width = width;
+    t->layout_dirty = 0;
+    return redone >= 0 ? redone : t->num_lines;
+}
+
+// SDL_Vertex is written as 5 floats at a time, colour bits included
+typedef char SL_VertexIsFiveFloats[sizeof(SDL_Vertex) == 5 * sizeof(float) ? 1 : -1];
+
+/*
+ * Writes the quads for glyphs [start, end) of one line, starting at the given pen position, and grows bounds
+ * to fit them. Per glyph it's position = pen + box * scale and a UV copy, which SSE2 does as one multiply-add
+ * and a handful of shuffles. Same arithmetic in the same order either way, so the output is identical.
+ */
+static void EmitQuads(SL_TextObject* t, int start, int end, int textx, int texty, SDL_Color c, float* bounds) {
+    const SL_GlyphTable* table = &t->font->table;
+    const float* uvs = textUvs(t);
+    SDL_Vertex* out = t->vertices + start * 4;
+    const int kerning = t->font->kerning_enabled;
+#ifdef SL_USE_SSE2
+    float color_bits;
+    memcpy(&color_bits, &c, sizeof(float));
+    const __m128 color = _mm_set1_ps(color_bits);
+    const __m128 scale = _mm_set1_ps(t->scale);
+    const float pen_y = (float)texty;
+    __m128 lo = _mm_setr_ps(bounds[0], bounds[0], bounds[1], bounds[1]);
+    __m128 hi = _mm_setr_ps(bounds[2], bounds[2], bounds[3], bounds[3]);
+
+    for (int i = start; i < end; i++, out += 4) {
+        int g = t->glyphs[i];
+        const float pen_x = (float)textx;
+        __m128 box = _mm_loadu_ps(table->boxes + g * 4);
+        __m128 uv = _mm_loadu_ps(uvs + g * 4);
+        // x0 x1 y0 y1
+        __m128 p = _mm_add_ps(_mm_setr_ps(pen_x, pen_x, pen_y, pen_y), _mm_mul_ps(box, scale));
+        lo = _mm_min_ps(lo, p);
+        hi = _mm_max_ps(hi, p);
+
+        // Lower left, upper left, lower right, upper right as 20 floats:
+        // x0 y1 c um | vm x0 y0 c | um vM x1 y1 | c uM vm x1 | y0 c uM vM
+        __m128 y0c = _mm_shuffle_ps(p, color, _MM_SHUFFLE(0, 0, 2, 2));
+        __m128 o0 = _mm_shuffle_ps(_mm_shuffle_ps(p, p, _MM_SHUFFLE(3, 0, 3, 0)),
+                                   _mm_shuffle_ps(color, uv, _MM_SHUFFLE(0, 0, 0, 0)), _MM_SHUFFLE(2, 0, 1, 0));
+        __m128 o1 = _mm_shuffle_ps(_mm_shuffle_ps(uv, p, _MM_SHUFFLE(0, 0, 2, 2)), y0c, _MM_SHUFFLE(2, 0, 2, 0));
+        __m128 o2 = _mm_shuffle_ps(_mm_shuffle_ps(uv, uv, _MM_SHUFFLE(3, 0, 3, 0)),
+                                   _mm_shuffle_ps(p, p, _MM_SHUFFLE(3, 1, 3, 1)), _MM_SHUFFLE(1, 0, 1, 0));
+        __m128 o3 = _mm_shuffle_ps(_mm_shuffle_ps(color, uv, _MM_SHUFFLE(1, 1, 0, 0)),
+                                   _mm_shuffle_ps(uv, p, _MM_SHUFFLE(1, 1, 2, 2)), _MM_SHUFFLE(2, 0, 2, 0));
+        __m128 o4 = _mm_shuffle_ps(y0c, _mm_shuffle_ps(uv, uv, _MM_SHUFFLE(3, 3, 1, 1)), _MM_SHUFFLE(2, 0, 2, 0));
+        float* dst = (float*)out;
+        _mm_storeu_ps(dst, o0);
+        _mm_storeu_ps(dst + 4, o1);
+        _mm_storeu_ps(dst + 8, o2);
+        _mm_storeu_ps(dst + 12, o3);
+        _mm_storeu_ps(dst + 16, o4);
+
+        int advance = kerning ? glyphAdvance(t, i) : table->advances[g];
+        textx += (int)((float)advance * t->scale);
+    }
+
+    float l[4], h[4];
+    _mm_storeu_ps(l, lo);
+    _mm_storeu_ps(h, hi);
+    bounds[0] = l[0];
+    bounds[1] = l[2];
+    bounds[2] = h[1];
+    bounds[3] = h[3];
+#else
+    for (int i = start; i < end; i++, out += 4) {
+        int g = t->glyphs[i];
+        const float* box = table->boxes + g * 4;
+        const float* uv = uvs + g * 4;
+        float x0 = (float)textx + box[0] * t->scale;
+        float x1 = (float)textx + box[1] * t->scale;
+        float y0 = (float)texty + box[2] * t->scale;
+        float y1 = (float)texty + box[3] * t->scale;
+
+        // Lower left, upper left, lower right, upper right
+        SDL_Vertex v1 = {{x0, y1}, c, {uv[0], uv[2]}};
+        SDL_Vertex v2 = {{x0, y0}, c, {uv[0], uv[3]}};
+        SDL_Vertex v3 = {{x1, y1}, c, {uv[1], uv[2]}};
+        SDL_Vertex v4 = {{x1, y0}, c, {uv[1], uv[3]}};
+        out[0] = v1;
+        out[1] = v2;
+        out[2] = v3;
+        out[3] = v4;
+
+        if (x0 < bounds[0]) bounds[0] = x0;
+        if (y0 < bounds[1]) bounds[1] = y0;
+        if (x1 > bounds[2]) bounds[2] = x1;
+        if (y1 > bounds[3]) bounds[3] = y1;
+
+        int advance = kerning ? glyphAdvance(t, i) : table->advances[g];
+        textx += (int)((float)advance * t->scale);
+    }
+#endif
+}
+
+/*
+ * Generates the quads for a text object from its cached lines, aligning each line within the element.
+ * Only called when something the geometry depends on changed, static text is just copied every frame.
+ */
+static void BuildTextGeometry(SL_TextObject* t, const SL_UIElement* element) {
+    int origin_x = t->x_start + element->src_rect.x;
+    int origin_y = t->y_start + element->src_rect.y;
+
+    // Sized to the capacity, which only changes alongside the text itself, so the indices never change. Text on a
+    // shared run has no glyph buffer of its own to go by, it gets exactly what it needs
+    if (!t->vertices || t->quad_capacity < t->length) {
+        int quads = t->capacity > t->length ? t->capacity : t->length;
+        free(t->vertices);
+        free(t->indices);
+        textBytesChanged((long)((quads - t->quad_capacity) * (4 * sizeof(SDL_Vertex) + 6 * sizeof(int))));
+        t->quad_capacity = quads;
+        t->vertices = slMalloc(quads * 4 * sizeof(SDL_Vertex));
+        t->indices = slMalloc(quads * 6 * sizeof(int));
+        const int idxs_raw[6] = {0, 1, 2, 1, 2, 3};
+        for (int i = 0; i < quads * 6; i++) {
+            t->indices[i] = idxs_raw[i % 6] + (i / 6) * 4;
+        }
+    }
+
+    SDL_Color color = modulateColor(t->c, element->tint);
+    // min x, min y, max x, max y
+    float bounds[4] = {(float)origin_x, (float)origin_y, (float)origin_x, (float)origin_y};
+
+    for (int l = 0; l < t->num_lines; l++) {
+        EmitLine(t, element, l, color, bounds);
+    }
+
+    float min_x = bounds[0], min_y = bounds[1], max_x = bounds[2], max_y = bounds[3];
+    t->bounds.x = (int)min_x;
+    t->bounds.y = (int)min_y;
+    t->bounds.w = (int)max_x - (int)min_x + 1;
+    t->bounds.h = (int)max_y - (int)min_y + 1;
+    t->font_generation = t->font->generation;
+    t->dirty = 0;
+}
+
+static void EmitLine(SL_TextObject* t, const SL_UIElement* element, int l, SDL_Color color, float* bounds) {
+    const SL_TextLine* line = &t->lines[l];
+    // Centre and right alignment use x_start as the margin on both sides
+    int box_width = element->src_rect.w - 2 * t->x_start;
+    int base = (int)((float)t->font->base * t->scale);
+    int textx = t->x_start + element->src_rect.x;
+    if (t->align == SL_TEXT_ALIGN_CENTER) {
+        textx += (box_width - line->width) / 2;
+    }
+    else if (t->align == SL_TEXT_ALIGN_RIGHT) {
+        textx += box_width - line->width;
+    }
+    int texty = t->y_start + element->src_rect.y + line->baseline - base;
+    EmitQuads(t, line->start, line->end, textx, texty, color, bounds);
+}
+
+/*
+ * Rebuilds the quads for lines [from, to) only, after RelayoutText. The glyphs after them haven't moved on screen,
+ * only along the buffer by delta. Bounds only ever grow here, a full rebuild tightens them again.
+ */
+static void PatchTextGeometry(SL_TextObject* t, const SL_UIElement* element, int from, int to, int delta) {
+    if (to < t->num_lines) {
+        int tail = t->lines[to].start;
+        memmove(t->vertices + tail * 4, t->vertices + (tail - delta) * 4, (t->length - tail) * 4 * sizeof(SDL_Vertex));
+    }
+    SDL_Color color = modulateColor(t->c, element->tint);
+    float bounds[4] = {(float)t->bounds.x, (float)t->bounds.y, (float)(t->bounds.x + t->bounds.w - 1),
+                       (float)(t->bounds.y + t->bounds.h - 1)};
+    for (int l = from; l < to; l++) {
+        EmitLine(t, element, l, color, bounds);
+    }
+    t->bounds.x = (int)bounds[0];
+    t->bounds.y = (int)bounds[1];
+    t->bounds.w = (int)bounds[2] - (int)bounds[0] + 1;
+    t->bounds.h = (int)bounds[3] - (int)bounds[1] + 1;
+}
+
+// Brings a text object's layout and geometry up to date, doing only the stages that are stale
+static void PrepareText(SL_TextObject* t, const SL_UIElement* element) {
+    if (t->font_generation != t->font->generation) {
+        // Metrics may have changed too (kerning toggled, font reloaded)
+        t->layout_dirty = 1;
+    }
+    if (t->layout_dirty || t->layout_width != element->src_rect.w) {
+        LayoutText(t, element->src_rect.w);
+    }
+    if (t->dirty) {
+        BuildTextGeometry(t, element);
+    }
+}
+
+void SL_LayoutText(SL_UIElement* element) {
+    if (!element) return;
+    for (int k = 0; k < element->textCount; k++) {
+        SL_TextObject* t = &element->TextObjects[k];
+        if (t->font_generation != t->font->generation || t->layout_dirty || t->layout_width != element->src_rect.w) {
+            LayoutText(t, element->src_rect.w);
+            t->font_generation = t->font->generation;
         }
-        for (int x = 0; x < 4; x++) {
-            int step_x;
-            switch (x) {
-                default: step_x = 0; break;
-                case 1: step_x = element->skin_step_x; break;
-                case 2: step_x = width - element->skin_step_x; break;
-                case 3: step_x = width; break;
+    }
+}
+
+const SL_TextLine* SL_GetTextLines(SL_UIElement* element, const char* id, int* count) {
+    *count = 0;
+    if (!element) return NULL;
+    SL_TextObject* t = findTextObject(element, findId(id));
+    if (!t) return NULL;
+    SL_LayoutText(element);
+    *count = t->num_lines;
+    return t->lines;
+}
+
+// Shape cache
+
+static uint32_t shapeHash(const SL_Font* font, float scale, int limit, uint32_t text_hash) {
+    uint32_t bits;
+    memcpy(&bits, &scale, sizeof(bits));
+    uint32_t hash = text_hash ^ (uint32_t)(uintptr_t)font;
+    hash = (hash ^ bits) * 16777619u;
+    return (hash ^ (uint32_t)limit) * 16777619u;
+}
+
+static void shapeUnlink(SL_ShapedRun* run) {
+    if (run->newer) run->newer->older = run->older;
+    else shape_newest = run->older;
+    if (run->older) run->older->newer = run->newer;
+    else shape_oldest = run->newer;
+    run->newer = NULL;
+    run->older = NULL;
+}
+
+static void shapePushNewest(SL_ShapedRun* run) {
+    run->older = shape_newest;
+    run->newer = NULL;
+    if (shape_newest) shape_newest->newer = run;
+    else shape_oldest = run;
+    shape_newest = run;
+}
+
+static void shapeRemove(SL_ShapedRun* run) {
+    SL_ShapedRun** link = &shape_buckets[run->hash & (shape_bucket_count - 1)];
+    while (*link != run) link = &(*link)->next;
+    *link = run->next;
+    shapeUnlink(run);
+    shape_stats.runs--;
+    shape_stats.bytes -= run->bytes;
+    free(run);
+}
+
+// Counts as a hit or a miss, and a hit becomes the most recently used
+static SL_ShapedRun* shapeFind(const SL_Font* font, float scale, int limit, const char* text, uint32_t hash) {
+    hash = shapeHash(font, scale, limit, hash);
+    SL_ShapedRun* run = shape_bucket_count ? shape_buckets[hash & (shape_bucket_count - 1)] : NULL;
+    for (; run; run = run->next) {
+        if (run->hash == hash && run->font == font && run->generation == font->generation &&
+            run->scale == scale && run->limit == limit && strcmp(run->text, text) == 0) {
+            break;
+        }
+    }
+    if (!run) {
+        shape_stats.misses++;
+        return NULL;
+    }
+    shape_stats.hits++;
+    shapeUnlink(run);
+    shapePushNewest(run);
+    return run;
+}
+
+// Copies a text that was just laid out into a new run, for the next text showing the same string to share
+static void shapeAdd(const SL_TextObject* t, int limit, const char* text, uint32_t hash) {
+    size_t text_size = strlen(text) + 1;
+    size_t bytes = sizeof(SL_ShapedRun) + t->num_lines * sizeof(SL_TextLine) + t->length * sizeof(uint16_t) + text_size;
+    if (bytes > shape_budget) return;
+
+    if (shape_stats.runs + 1 > (int)((float)shape_bucket_count * MAP_MAX_LOAD)) {
+        int count = shape_bucket_count ? shape_bucket_count * 2 : SHAPE_CACHE_BUCKETS;
+        SL_ShapedRun** buckets = slCalloc(count, sizeof(SL_ShapedRun*));
+        for (int i = 0; i < shape_bucket_count; i++) {
+            while (shape_buckets[i]) {
+                SL_ShapedRun* run = shape_buckets[i];
+                shape_buckets[i] = run->next;
+                run->next = buckets[run->hash & (count - 1)];
+                buckets[run->hash & (count - 1)] = run;
             }
-            int rx = start_x + step_x;
-            int ry = start_y + step_y;
-            float uvx = (float)x / 3.0f;
-            float uvy = (float)y / 3.0f;
+        }
+        free(shape_buckets);
+        shape_buckets = buckets;
+        shape_bucket_count = count;
+    }
 
-            int idx = (y * 4) + x;
-            SDL_Vertex v = {
-                {(float)rx, (float)ry},
-                {0xFF, 0xFF, 0xFF, 0xFF},
-                {uvx, uvy},
-            };
-            vertices[idx] = v;
+    SL_ShapedRun* run = slMalloc(bytes);
+    memset(run, 0, sizeof(SL_ShapedRun));
+    run->hash = shapeHash(t->font, t->scale, limit, hash);
+    run->font = t->font;
+    run->generation = t->font->generation;
+    run->scale = t->scale;
+    run->limit = limit;
+    run->bytes = bytes;
+    run->length = t->length;
+    run->num_lines = t->num_lines;
+    run->lines = (SL_TextLine*)(run + 1);
+    run->glyphs = (uint16_t*)(run->lines + run->num_lines);
+    run->text = (char*)(run->glyphs + run->length);
+    memcpy(run->lines, t->lines, run->num_lines * sizeof(SL_TextLine));
+    memcpy(run->glyphs, t->glyphs, run->length * sizeof(uint16_t));
+    memcpy(run->text, text, text_size);
+
+    SL_ShapedRun** bucket = &shape_buckets[run->hash & (shape_bucket_count - 1)];
+    run->next = *bucket;
+    *bucket = run;
+    shapePushNewest(run);
+    shape_stats.runs++;
+    shape_stats.bytes += bytes;
+    shapeTrim(shape_budget);
+}
+
+// Oldest first, skipping anything a text is still on
+static void shapeTrim(size_t budget) {
+    SL_ShapedRun* run = shape_oldest;
+    while (run && shape_stats.bytes > budget) {
+        SL_ShapedRun* newer = run->newer;
+        if (SDL_AtomicGet(&run->refs) == 0) {
+            shapeRemove(run);
+            shape_stats.evictions++;
+        }
+        run = newer;
+    }
+}
+
+static void shapePurgeFont(const SL_Font* font) {
+    SL_ShapedRun* run = shape_oldest;
+    while (run) {
+        SL_ShapedRun* newer = run->newer;
+        if (run->font == font && SDL_AtomicGet(&run->refs) == 0) {
+            shapeRemove(run);
         }
+        run = newer;
+    }
+}
+
+static void shapeCacheQuit(void) {
+    while (shape_oldest) {
+        shapeRemove(shape_oldest);
     }
-    SDL_RenderGeometry(render_context, element->texture_skin, vertices, NUM_VERTICES, indices, NUM_INDICES);
+    free(shape_buckets);
+    shape_buckets = NULL;
+    shape_bucket_count = 0;
+}
 
-    for (int k = 0; k < element->textMapCount; k++) {
-        SL_TextObject t = (element->TextObjectMap[element->TextObjectIterator[k]]);
+void SL_SetShapeCacheBudget(size_t bytes) {
+    shape_budget = bytes;
+    shapeTrim(bytes);
+}
 
-        int textx = t.x_start + start_x;
-        int texty = t.y_start + start_y;
-        int line_break_limit = start_x + width;
+SL_ShapeCacheStats SL_GetShapeCacheStats(void) {
+    SL_ShapeCacheStats stats = shape_stats;
+    stats.budget = shape_budget;
+    return stats;
+}
 
-        static const int quad_pts = 4;
-        static const int quad_idx = 6;
+// The text's own buffers are kept aside, untouched, for when it comes off the run
+static void attachRun(SL_TextObject* t, SL_ShapedRun* run, int width) {
+    SDL_AtomicAdd(&run->refs, 1);
+    t->run = run;
+    t->own_glyphs = t->glyphs;
+    t->own_lines = t->lines;
+    t->glyphs = run->glyphs;
+    t->lines = run->lines;
+    t->length = run->length;
+    t->num_lines = run->num_lines;
+    t->layout_width = width;
+    t->layout_dirty = 0;
+}
 
-        int num_text_vertices = t.length * quad_pts;
-        int num_text_indices = t.length * quad_idx;
+// Back to the text's own buffers, without copying anything into them
+static void releaseRun(SL_TextObject* t) {
+    if (!t->run) return;
+    t->glyphs = t->own_glyphs;
+    t->lines = t->own_lines;
+    t->own_glyphs = NULL;
+    t->own_lines = NULL;
+    SDL_AtomicAdd(&t->run->refs, -1);
+    t->run = NULL;
+}
 
-        SDL_Vertex text_vertices[num_text_vertices];
-        int idxs[num_text_indices];
+// Copies the run into the text's own buffers so it can be changed. Safe on the job threads, runs are only ever
+// freed from the main thread and not while a text is on them
+static void unshareText(SL_TextObject* t) {
+    if (!t->run) return;
+    const SL_ShapedRun* run = t->run;
+    size_t old_bytes = textObjectBytes(t);
+    t->glyphs = t->own_glyphs;
+    t->lines = t->own_lines;
+    reserveText(t, run->length);
+    if (t->line_limit < run->num_lines) {
+        t->line_limit = run->num_lines;
+        t->lines = slRealloc(t->lines, t->line_limit * sizeof(SL_TextLine));
+    }
+    memcpy(t->glyphs, run->glyphs, run->length * sizeof(uint16_t));
+    memcpy(t->lines, run->lines, run->num_lines * sizeof(SL_TextLine));
+    t->own_glyphs = t->glyphs;
+    t->own_lines = t->lines;
+    releaseRun(t);
+    textBytesChanged((long)textObjectBytes(t) - (long)old_bytes);
+}
 
-        const int idxs_raw[6] = {0, 1, 2, 1, 2, 3};
+// Jobs
 
-        int curr_word = 0;
+static void textBytesChanged(long delta) {
+    SDL_AtomicLock(&text_bytes_lock);
+    memory_stats.text += delta;
+    SDL_AtomicUnlock(&text_bytes_lock);
+}
 
-        for (int i = 0; i < t.length; i++) {
+static void prepareElementText(SL_UIElement* element) {
+    for (int k = 0; k < element->textCount; k++) {
+        PrepareText(&element->TextObjects[k], element);
+    }
+}
 
-            for (int j = i * quad_idx; j < (i * quad_idx) + quad_idx; j++) {
-                idxs[j] = idxs_raw[j % quad_idx] + (i * quad_pts);
-            }
+// Own queue from the front, then everyone else's from the back. -1 once there's nothing left anywhere
+static int takeJob(int self) {
+    int queues = job_thread_count + 1;
+    int job = -1;
+    for (int i = 0; i < queues && job < 0; i++) {
+        SL_JobQueue* q = &job_queues[(self + i) % queues];
+        SDL_AtomicLock(&q->lock);
+        if (q->head < q->tail) {
+            job = i == 0 ? q->head++ : --q->tail;
+        }
+        SDL_AtomicUnlock(&q->lock);
+    }
+    return job;
+}
+
+static void runJobs(int self) {
+    int job;
+    while ((job = takeJob(self)) >= 0) {
+        prepareElementText(job_elements[job]);
+        if (SDL_AtomicAdd(&job_pending, -1) == 1) {
+            SDL_SemPost(job_done);
+        }
+    }
+}
 
-            SL_Glyph g = t.text[i];
+static int jobThread(void* data) {
+    int self = (int)(intptr_t)data;
+    for (;;) {
+        SDL_SemWait(job_wake);
+        if (SDL_AtomicGet(&job_quit)) break;
+        // Woken late for a batch that's already done is fine, there's just nothing to take
+        runJobs(self);
+    }
+    return 0;
+}
 
-            // Lower Left
-            SDL_Vertex v1 = {
-                    {(float)textx + (float)(g.x_offset) * t.scale, (float)texty + ((float)(g.src.h + g.y_offset) * t.scale)},
-                    t.c,
-                    {g.u_min, g.v_min}
-            };
-            // Upper Left
-            SDL_Vertex v2 = {
-                    {(float)textx + ((float)g.x_offset * t.scale), (float)texty + (float)g.y_offset * t.scale},
-                    t.c,
-                    {g.u_min, g.v_max}
-            };
-            // Lower Right
-            SDL_Vertex v3 = {
-                    {(float)textx + ((float)(g.src.w + g.x_offset) * t.scale), (float)texty + ((float)(g.src.h + g.y_offset) * t.scale)},
-                    t.c,
-                    {g.u_max, g.v_min}
-            };
-            // Upper Right
-            SDL_Vertex v4 = {
-                    {(float)textx + ((float)(g.src.w + g.x_offset) * t.scale), (float)texty + ((float)g.y_offset * t.scale)},
-                    t.c,
-                    {g.u_max, g.v_max}
-            };
-            text_vertices[i * quad_pts] = v1;
-            text_vertices[(i * quad_pts) + 1] = v2;
-            text_vertices[(i * quad_pts) + 2] = v3;
-            text_vertices[(i * quad_pts) + 3] = v4;
-            textx += (int)((float)g.x_advance * t.scale);
-
-            if (g.raw_char == ' ') {
-                curr_word++;
-                if (textx > line_break_limit || textx + t.word_widths[curr_word] > line_break_limit) {
-                    textx = t.x_start + start_x;
-                    texty += (int) ((float) lineHeight * t.scale);
-                }
-            }
+static void reserveJobElements(int count) {
+    if (count <= job_element_limit) return;
+    while (job_element_limit < count) {
+        job_element_limit = job_element_limit ? job_element_limit * 2 : 64;
+    }
+    job_elements = slRealloc(job_elements, job_element_limit * sizeof(SL_UIElement*));
+}
+
+// Runs job_elements[0, count) across the pool and waits for all of it. Each job only writes to its own
+// element's text, so the result is the same whatever order they ran in
+static void runElementJobs(int count) {
+    if (job_thread_count == 0 || count < 2) {
+        for (int i = 0; i < count; i++) {
+            prepareElementText(job_elements[i]);
+        }
+        return;
+    }
+
+    int queues = job_thread_count + 1;
+    SDL_AtomicSet(&job_pending, count);
+    for (int q = 0; q < queues; q++) {
+        SDL_AtomicLock(&job_queues[q].lock);
+        job_queues[q].head = count * q / queues;
+        job_queues[q].tail = count * (q + 1) / queues;
+        SDL_AtomicUnlock(&job_queues[q].lock);
+    }
+    int wake = count - 1 < job_thread_count ? count - 1 : job_thread_count;
+    for (int i = 0; i < wake; i++) {
+        SDL_SemPost(job_wake);
+    }
+    runJobs(0);
+    SDL_SemWait(job_done);
+}
+
+int SL_SetJobThreads(int count) {
+    if (count < 1) count = 1;
+    if (count > JOB_THREADS_MAX) count = JOB_THREADS_MAX;
+    if (count - 1 == job_thread_count) return 0;
+
+    if (job_thread_count > 0) {
+        SDL_AtomicSet(&job_quit, 1);
+        for (int i = 0; i < job_thread_count; i++) {
+            SDL_SemPost(job_wake);
         }
+        for (int i = 0; i < job_thread_count; i++) {
+            SDL_WaitThread(job_threads[i + 1], NULL);
+        }
+        job_thread_count = 0;
+        SDL_DestroySemaphore(job_wake);
+        SDL_DestroySemaphore(job_done);
+        job_wake = NULL;
+        job_done = NULL;
+        SDL_AtomicSet(&job_quit, 0);
+    }
+    if (count == 1) return 0;
 
-        // TODO With a little more work I can make this one draw call all together
-        SDL_RenderGeometry(render_context, element->font, text_vertices, num_text_vertices, idxs, num_text_indices);
+    job_wake = SDL_CreateSemaphore(0);
+    job_done = SDL_CreateSemaphore(0);
+    if (!job_wake || !job_done) {
+        if (job_wake) SDL_DestroySemaphore(job_wake);
+        if (job_done) SDL_DestroySemaphore(job_done);
+        job_wake = NULL;
+        job_done = NULL;
+        return -1;
     }
+    for (int i = 1; i < count; i++) {
+        job_threads[i] = SDL_CreateThread(jobThread, "sliggy_job", (void*)(intptr_t)i);
+        if (!job_threads[i]) {
+            // Keep whatever did start rather than failing outright
+            SDL_Log("Sliggy: only started %d of %d job threads: %s", i - 1, count - 1, SDL_GetError());
+            break;
+        }
+        job_thread_count++;
+    }
+    return 0;
 }
 
-static SL_TextObject CreateTextObject(const char *raw_text, float desired_size, int x_, int y_) {
-    SL_TextObject obj;
-    // TODO set color
-    obj.c = Color_White;
-    obj.x_start = x_;
-    obj.y_start = y_;
-    obj.scale = desired_size / font_size;
-    obj.length = 0;
-    obj.num_words = 1;
-
-    for (char* c_tmp = (char*) raw_text; *c_tmp != '\0'; c_tmp++) {
-        obj.length++;
-        if (*c_tmp == ' ') {
-            obj.num_words++;
-        }
-    }
-    obj.word_widths = calloc(obj.num_words, sizeof(int));
-    obj.text = calloc(obj.length, sizeof(SL_Glyph));
-    int curr_word_width = 0;
-    int curr_word = 0;
-    for (int i = 0; i < obj.length; i++) {
-        obj.text[i] = getGlyph(raw_text[i]);
-        if (raw_text[i] == ' ') {
-            obj.word_widths[curr_word++] = curr_word_width;
-            curr_word_width = 0;
+int SL_GetJobThreads(void) {
+    return job_thread_count + 1;
+}
+
+void SL_PrepareElements(SL_UIElement* const* elements, int count) {
+    if (!elements || count <= 0) return;
+    reserveJobElements(count);
+    int jobs = 0;
+    for (int i = 0; i < count; i++) {
+        if (elements[i] && elements[i]->textCount > 0) {
+            job_elements[jobs++] = elements[i];
         }
-        else {
-            curr_word_width += (int)((float)obj.text[i].x_advance * obj.scale);
+    }
+    runElementJobs(jobs);
+}
+
+static void MarkTextDirty(SL_UIElement* element, int relayout) {
+    for (int k = 0; k < element->textCount; k++) {
+        element->TextObjects[k].dirty = 1;
+        element->TextObjects[k].layout_dirty |= relayout;
+    }
+    if (element->list) {
+        for (int i = 0; i < element->list->slot_count; i++) {
+            for (int c = 0; c < SL_LIST_MAX_COLUMNS; c++) {
+                element->list->slots[i].columns[c].dirty = 1;
+                element->list->slots[i].columns[c].layout_dirty |= relayout;
+            }
         }
     }
-    return obj;
+}
+
+// Colour lives in every vertex, but changing it doesn't need the quads rebuilt
+static void RecolorText(SL_TextObject* t, SDL_Color color) {
+    for (int i = 0; i < t->length * 4; i++) {
+        t->vertices[i].color = color;
+    }
 }
 
 static void DestroyTextObject(SL_TextObject* ptr) {
-    free(ptr->text);
-    free(ptr->word_widths);
-    free(ptr);
+    releaseRun(ptr);
+    sdfRelease(ptr->font, ptr->sdf_size);
+    memory_stats.text -= textObjectBytes(ptr);
+    free(ptr->glyphs);
+    free(ptr->vertices);
+    free(ptr->indices);
+    free(ptr->lines);
+    ptr->lines = NULL;
+    ptr->glyphs = NULL;
+    ptr->vertices = NULL;
+    ptr->indices = NULL;
+    ptr->capacity = 0;
+    ptr->line_limit = 0;
+    ptr->quad_capacity = 0;
+    ptr->sdf_size = -1;
+    SL_ReleaseFont(ptr->font);
+    ptr->font = NULL;
+}
+
+// Lets go of the font but keeps the buffers for whatever text ends up here next
+static void ParkTextObject(SL_TextObject* ptr) {
+    releaseRun(ptr);
+    sdfRelease(ptr->font, ptr->sdf_size);
+    ptr->sdf_size = -1;
+    SL_ReleaseFont(ptr->font);
+    ptr->font = NULL;
+    ptr->on_reveal = NULL;
+    ptr->reveal_userdata = NULL;
 }
 
 
@@ -717,19 +5180,454 @@ int SL_ElementIsActive(const SL_UIElement* element) {
 }
 
 void SL_ActivateElement(SL_UIElement* element) {
-    if (!element) return;
+    if (!element || SL_ElementIsActive(element)) return;
     element->flags |= SL_INNERFLAG_ACTIVE;
+    damageElement(element);
 }
 
 void SL_DeactivateElement(SL_UIElement* element) {
-    if (!element) return;
+    if (!element || !SL_ElementIsActive(element)) return;
+    damageElement(element);
     element->flags &= ~SL_INNERFLAG_ACTIVE;
 }
 
+void SL_SetDimensionsAbsolute(SL_UIElement* element, const int* x, const int* y, const int* w, const int* h) {
+    if (!element) return;
+    damageElement(element);
+    if (x != NULL)
+        element->src_rect.x = *x;
+    if (y != NULL)
+        element->src_rect.y = *y;
+    if (w != NULL)
+        element->src_rect.w = *w;
+    if (h != NULL)
+        element->src_rect.h = *h;
+    BakeSkin(element);
+    // Lines notice a width change by themselves
+    MarkTextDirty(element, 0);
+}
+
+void SL_SetSkin(SL_UIElement* element, SDL_Texture* skin) {
+    SL_SetSkinRegion(element, skin, NULL);
+}
+
+void SL_SetSkinRegion(SL_UIElement* element, SDL_Texture* skin, const SDL_Rect* region) {
+    if (!element) return;
+    damageElement(element);
+    applySkin(element, skin, region);
+    BakeSkin(element);
+}
+
+void SL_SetTint(SL_UIElement* element, SDL_Color tint) {
+    if (!element) return;
+    damageElement(element);
+    element->tint = tint;
+    TintSkin(element);
+    for (int k = 0; k < element->textCount; k++) {
+        SL_TextObject* t = &element->TextObjects[k];
+        if (t->vertices && !t->dirty) {
+            RecolorText(t, modulateColor(t->c, tint));
+        }
+    }
+    for (int i = 0; element->list && i < element->list->slot_count; i++) {
+        for (int c = 0; c < element->list->column_count; c++) {
+            SL_TextObject* t = &element->list->slots[i].columns[c];
+            if (t->vertices && !t->dirty) {
+                RecolorText(t, modulateColor(t->c, tint));
+            }
+        }
+    }
+}
+
+void SL_SetTextAlign(SL_UIElement* element, const char* id, SL_TextAlign align) {
+    if (!element) return;
+    SL_TextObject* t = findTextObject(element, findId(id));
+    if (!t || t->align == align) return;
+    damageElement(element);
+    t->align = align;
+    t->dirty = 1;
+}
+
+void SL_SetTextColor(SL_UIElement* element, const char* id, SDL_Color color) {
+    SL_SetTextColorById(element, findId(id), color);
+}
+
+void SL_SetTextColorById(SL_UIElement* element, SL_Id id, SDL_Color color) {
+    if (!element) return;
+    SL_TextObject* t = findTextObject(element, id);
+    if (!t) return;
+    damageElement(element);
+    t->c = color;
+    if (t->vertices && !t->dirty) {
+        RecolorText(t, modulateColor(color, element->tint));
+    }
+}
+
+void SL_SetTextSize(SL_UIElement* element, const char* id, float size) {
+    SL_SetTextSizeById(element, findId(id), size);
+}
+
+void SL_SetTextSizeById(SL_UIElement* element, SL_Id id, float size) {
+    if (!element) return;
+    SL_TextObject* t = findTextObject(element, id);
+    if (!t) return;
+    damageElement(element);
+    t->scale = size / t->font->size;
+    t->layout_dirty = 1;
+    if (t->sdf_size >= 0) {
+        // Taken before letting go so staying at the same size doesn't rasterise again
+        int old = t->sdf_size;
+        t->sdf_size = sdfAcquire(t->font, t->scale);
+        sdfRelease(t->font, old);
+    }
+}
+
+void SL_SetText(SL_UIElement* element, const char* id, const char* text) {
+    SL_SetTextById(element, findId(id), text);
+}
+
+/*
+ * New glyphs are written over the old ones in place. Whatever the old and new text have in common at either end
+ * is left alone, so only the lines the edit reaches get laid out and rebuilt, and the rest of the quads are kept.
+ */
+void SL_SetTextById(SL_UIElement* element, SL_Id id, const char* text) {
+    if (!element || !text) return;
+    SL_TextObject* t = findTextObject(element, id);
+    if (!t) return;
+    // Setting a label to what it already says every frame keeps it on the shared run
+    if (t->run && strcmp(t->run->text, text) == 0) return;
+    unshareText(t);
+
+    int old_length = t->length;
+    int length = utf8Length(text);
+    int delta = length - old_length;
+    size_t old_bytes = textObjectBytes(t);
+    reserveText(t, length);
+    memory_stats.text += textObjectBytes(t) - old_bytes;
+
+    // Common prefix first, then the old tail is lined up with the end of the new text so the rest compares
+    // against whatever was at the same distance from the end
+    const unsigned char* c = (const unsigned char*) text;
+    int first = 0;
+    for (; first < length; first++) {
+        const unsigned char* next = c;
+        uint32_t cp = *next < 0x80 ? *next++ : decodeUtf8(&next);
+        uint16_t glyph = glyphSlot(t->font, cp);
+        if (first >= old_length || t->glyphs[first] != glyph) break;
+        c = next;
+    }
+    int tail = delta < 0 ? first - delta : first;
+    if (tail < old_length && delta != 0) {
+        memmove(t->glyphs + tail + delta, t->glyphs + tail, (old_length - tail) * sizeof(uint16_t));
+    }
+    // One past the last glyph that differs, anything the tail was moved over counts as changed
+    int settled = first + (delta > 0 ? delta : 0);
+    for (int i = first; i < length; i++) {
+        uint32_t cp = *c < 0x80 ? *c++ : decodeUtf8(&c);
+        uint16_t glyph = glyphSlot(t->font, cp);
+        if (t->glyphs[i] != glyph || i < first + delta) {
+            t->glyphs[i] = glyph;
+            settled = i + 1;
+        }
+    }
+    if (delta == 0 && settled == first) return;
+
+    damageElement(element);
+    t->length = length;
+    if (t->visible == old_length || t->visible > length) {
+        t->visible = length;
+    }
+
+    // Anything already stale gets done in full on the next draw anyway
+    if (t->layout_dirty || t->layout_width != element->src_rect.w || t->font_generation != t->font->generation ||
+        t->num_lines == 0) {
+        t->layout_dirty = 1;
+        return;
+    }
+    // The edit can pull its first word back onto the line before, and kerning reaches back a glyph
+    int from = 0;
+    while (from + 1 < t->num_lines && t->lines[from + 1].start <= first) from++;
+    if (from > 0) from--;
+    int to = RelayoutText(t, element->src_rect.w, from, settled, delta);
+    if (!t->dirty && t->vertices) {
+        PatchTextGeometry(t, element, from, to, delta);
+    }
+}
+
+// Typewriter
+
+// Shows up to count glyphs, running the callback for each one that appears. The callback can skip or restart
+// the reveal, so the text is re-read after every call
+static void revealGlyphs(SL_UIElement* element, SL_TextObject* t, int count) {
+    if (count > t->length) count = t->length;
+    if (count <= t->visible) return;
+    damageElement(element);
+    if (!t->on_reveal) {
+        t->visible = count;
+        return;
+    }
+    while (t->visible < count) {
+        int i = t->visible++;
+        t->on_reveal(element, t->id, i, t->font->table.codepoints[t->glyphs[i]], t->reveal_userdata);
+    }
+}
+
+void SL_SetTextVisibleCount(SL_UIElement* element, const char* id, int count) {
+    if (!element) return;
+    SL_TextObject* t = findTextObject(element, findId(id));
+    if (!t) return;
+    if (count < 0 || count > t->length) count = t->length;
+    if (count == t->visible) return;
+    damageElement(element);
+    t->visible = count;
+    t->reveal_progress = 0;
+}
+
+int SL_GetTextVisibleCount(SL_UIElement* element, const char* id) {
+    if (!element) return 0;
+    SL_TextObject* t = findTextObject(element, findId(id));
+    return t ? t->visible : 0;
+}
+
+void SL_RevealText(SL_UIElement* element, const char* id, float chars_per_second, SL_RevealCallback callback, void* userdata) {
+    if (!element) return;
+    SL_TextObject* t = findTextObject(element, findId(id));
+    if (!t) return;
+    damageElement(element);
+    t->visible = 0;
+    t->reveal_rate = chars_per_second > 0 ? chars_per_second : 0;
+    t->reveal_progress = 0;
+    t->on_reveal = callback;
+    t->reveal_userdata = userdata;
+}
+
+void SL_SetRevealSpeed(SL_UIElement* element, const char* id, float chars_per_second) {
+    if (!element) return;
+    SL_TextObject* t = findTextObject(element, findId(id));
+    if (!t || t->reveal_rate == 0) return;
+    // A rate of 0 would end the reveal, so pausing is left to not calling SL_UpdateReveal
+    if (chars_per_second > 0) {
+        t->reveal_rate = chars_per_second;
+    }
+}
+
+void SL_SkipReveal(SL_UIElement* element, const char* id) {
+    if (!element) return;
+    SL_Id text_id = id ? findId(id) : 0;
+    for (int k = 0; k < element->textCount; k++) {
+        SL_TextObject* t = &element->TextObjects[k];
+        if (id && t->id != text_id) continue;
+        if (t->visible != t->length) {
+            damageElement(element);
+            t->visible = t->length;
+        }
+        t->reveal_rate = 0;
+        t->reveal_progress = 0;
+    }
+}
+
+int SL_UpdateReveal(SL_UIElement* element, float dt) {
+    if (!element || dt <= 0) return 0;
+    int running = 0;
+    for (int k = 0; k < element->textCount; k++) {
+        SL_TextObject* t = &element->TextObjects[k];
+        if (t->reveal_rate == 0) continue;
+
+        // Clamped as a float first, a long hitch times a fast rate can overflow an int
+        int remaining = t->length - t->visible;
+        t->reveal_progress += dt * t->reveal_rate;
+        int step = t->reveal_progress >= (float)remaining ? remaining : (int)t->reveal_progress;
+        t->reveal_progress -= (float)step;
+        revealGlyphs(element, t, t->visible + step);
+
+        if (t->visible >= t->length) {
+            t->reveal_rate = 0;
+            t->reveal_progress = 0;
+        }
+        else if (t->reveal_rate > 0) {
+            running++;
+        }
+    }
+    return running;
+}
+
+// Lists
+
+static void freeListSlots(SL_ListState* list) {
+    for (int i = 0; i < list->slot_count; i++) {
+        for (int c = 0; c < SL_LIST_MAX_COLUMNS; c++) {
+            DestroyTextObject(&list->slots[i].columns[c]);
+        }
+    }
+    free(list->slots);
+    memory_stats.elements -= list->slot_count * sizeof(SL_ListSlot);
+    list->slots = NULL;
+    list->slot_count = 0;
+}
+
+static void freeList(SL_UIElement* element) {
+    if (!element->list) return;
+    freeListSlots(element->list);
+    free(element->list);
+    memory_stats.elements -= sizeof(SL_ListState);
+    element->list = NULL;
+}
+
+// Enough slots for every row that can be partly on screen at once, only redone when the height changes
+static void reserveListSlots(SL_ListState* list, int height) {
+    int count = (height + list->row_height - 1) / list->row_height + 1;
+    if (count == list->slot_count) return;
+    freeListSlots(list);
+    list->slots = slCalloc(count, sizeof(SL_ListSlot));
+    list->slot_count = count;
+    memory_stats.elements += count * sizeof(SL_ListSlot);
+    for (int i = 0; i < count; i++) {
+        list->slots[i].row = -1;
+    }
+}
+
+static void fillListSlot(const SL_UIElement* element, SL_ListState* list, SL_ListSlot* slot, int row) {
+    SL_ListRow content;
+    memset(&content, 0, sizeof(content));
+    content.color = Color_White;
+    list->callback((SL_UIElement*)element, row, &content, list->userdata);
+
+    for (int c = 0; c < list->column_count; c++) {
+        SL_TextObject* t = &slot->columns[c];
+        ParkTextObject(t);
+        InitTextObject(t, element->font, content.columns[c] ? content.columns[c] : "", list->text_size,
+                       list->columns[c], -1, 0);
+        t->c = content.color;
+    }
+    slot->row = row;
+    slot->generation = element->font->generation;
+}
+
+/*
+ * Cuts the quads of a row down to its band of the list, moving v along with y so nothing gets squashed.
+ * Clamping twice gives the same answer, so it's safe to run on quads that were already clipped
+ */
+static void clipQuadsY(SDL_Vertex* v, int count, float top, float bottom) {
+    for (int q = 0; q < count; q++, v += 4) {
+        float y0 = v[0].position.y, y1 = v[0].position.y;
+        float v0 = v[0].tex_coord.y, v1 = v[0].tex_coord.y;
+        for (int i = 1; i < 4; i++) {
+            if (v[i].position.y < y0) { y0 = v[i].position.y; v0 = v[i].tex_coord.y; }
+            if (v[i].position.y > y1) { y1 = v[i].position.y; v1 = v[i].tex_coord.y; }
+        }
+        if (y0 >= top && y1 <= bottom) continue;
+        for (int i = 0; i < 4; i++) {
+            float y = v[i].position.y;
+            float clamped = y < top ? top : (y > bottom ? bottom : y);
+            if (clamped != y && y1 > y0) {
+                v[i].tex_coord.y = v0 + (v1 - v0) * (clamped - y0) / (y1 - y0);
+            }
+            v[i].position.y = clamped;
+        }
+    }
+}
+
 /*
- * Check to see if an elements exists within calloc-allocated memory
- * Useful to see if an element exists at a given index in a hashmap
+ * Brings the rows on screen up to date and draws them. Rows that were already on screen keep their layout, a
+ * scroll only moves their quads. Everything here scales with the rows that fit in the rect, not the list
  */
-static int itemAtAddressExists(void* ptr) {
-    return *((int*)ptr) == 0 ? 0 : 1;
-}
\ No newline at end of file
+static void updateList(const SL_UIElement* element) {
+    SL_ListState* list = element->list;
+    if (!element->font || list->row_count == 0 || element->src_rect.h <= 0) return;
+    reserveListSlots(list, element->src_rect.h);
+
+    int first = list->scroll / list->row_height;
+    int last = (list->scroll + element->src_rect.h + list->row_height - 1) / list->row_height;
+    if (last > list->row_count) last = list->row_count;
+    float view_top = (float)element->src_rect.y;
+    float view_bottom = (float)(element->src_rect.y + element->src_rect.h);
+
+    for (int r = first; r < last; r++) {
+        SL_ListSlot* slot = &list->slots[r % list->slot_count];
+        // A reloaded font means the glyph indices are stale, the callback has to run again anyway
+        if (slot->row != r || slot->generation != element->font->generation) {
+            fillListSlot(element, list, slot, r);
+        }
+
+        int y = r * list->row_height - list->scroll;
+        float band_top = (float)(element->src_rect.y + y);
+        float band_bottom = band_top + (float)list->row_height;
+        if (band_top < view_top) band_top = view_top;
+        if (band_bottom > view_bottom) band_bottom = view_bottom;
+
+        for (int c = 0; c < list->column_count; c++) {
+            SL_TextObject* t = &slot->columns[c];
+            if (t->length == 0) continue;
+            if (t->y_start != y) {
+                t->y_start = y;
+                t->dirty = 1;
+            }
+            PrepareText(t, element);
+            clipQuadsY(t->vertices, t->length, band_top, band_bottom);
+            drawText(t);
+        }
+    }
+}
+
+static int maxListScroll(const SL_UIElement* element) {
+    int max = element->list->row_count * element->list->row_height - element->src_rect.h;
+    return max > 0 ? max : 0;
+}
+
+void SL_SetListRowCount(SL_UIElement* element, int row_count) {
+    if (!element || !element->list) return;
+    SL_ListState* list = element->list;
+    damageElement(element);
+    list->row_count = row_count > 0 ? row_count : 0;
+    // Rows past the new end might come back as something else
+    for (int i = 0; i < list->slot_count; i++) {
+        if (list->slots[i].row >= list->row_count) list->slots[i].row = -1;
+    }
+    if (list->scroll > maxListScroll(element)) list->scroll = maxListScroll(element);
+}
+
+int SL_GetListRowCount(const SL_UIElement* element) {
+    return element && element->list ? element->list->row_count : 0;
+}
+
+void SL_SetListScroll(SL_UIElement* element, int scroll) {
+    if (!element || !element->list) return;
+    int max = maxListScroll(element);
+    if (scroll > max) scroll = max;
+    if (scroll < 0) scroll = 0;
+    if (scroll == element->list->scroll) return;
+    damageElement(element);
+    element->list->scroll = scroll;
+}
+
+int SL_GetListScroll(const SL_UIElement* element) {
+    return element && element->list ? element->list->scroll : 0;
+}
+
+void SL_ScrollListTo(SL_UIElement* element, int row) {
+    if (!element || !element->list) return;
+    const SL_ListState* list = element->list;
+    int top = row * list->row_height;
+    if (top < list->scroll) {
+        SL_SetListScroll(element, top);
+    }
+    else if (top + list->row_height > list->scroll + element->src_rect.h) {
+        SL_SetListScroll(element, top + list->row_height - element->src_rect.h);
+    }
+}
+
+void SL_RefreshListRow(SL_UIElement* element, int row) {
+    if (!element || !element->list || element->list->slot_count == 0 || row < 0) return;
+    SL_ListSlot* slot = &element->list->slots[row % element->list->slot_count];
+    if (slot->row != row) return;
+    damageElement(element);
+    slot->row = -1;
+}
+
+void SL_RefreshList(SL_UIElement* element) {
+    if (!element || !element->list) return;
+    damageElement(element);
+    for (int i = 0; i < element->list->slot_count; i++) {
+        element->list->slots[i].row = -1;
+    }
+}
@@ -12,9 +12,76 @@ extern "C" {
 #include <SDL_render.h>
 
 #define SL_FLAGS_MANAGE_MEMORY 0b10
+#define SL_NO_ID 0
+#define SL_NO_HANDLE 0
+
+// Interned element name / text id - compare these instead of strings
+typedef Uint32 SL_Id;
+// Generational element handle - stops resolving once the element is freed, even if its slot gets reused.
+// Slot in the low 32 bits, the slot's generation in the high 32
+typedef Uint64 SL_Handle;
 
 typedef struct SL_UIE_INNER_ SL_UIElement;
 typedef struct SL_UIEB_INNER_ SL_UIElementBuilder;
+typedef struct SL_FONT_INNER_ SL_Font;
+typedef struct SL_ATLAS_INNER_ SL_Atlas;
+
+#define SL_LIST_MAX_COLUMNS 4
+
+// What a virtual list's callback fills in for a row. Strings are copied, so they can point anywhere
+typedef struct SL_ListRow {
+    const char* columns[SL_LIST_MAX_COLUMNS]; // NULL leaves the cell empty
+    SDL_Color color; // white unless set
+} SL_ListRow;
+
+typedef void (*SL_ListRowCallback)(SL_UIElement* list, int row, SL_ListRow* out, void* userdata);
+
+typedef enum SL_TextAlign {
+    SL_TEXT_ALIGN_LEFT,
+    SL_TEXT_ALIGN_CENTER,
+    SL_TEXT_ALIGN_RIGHT
+} SL_TextAlign;
+
+// One wrapped line of a text object - glyphs [start, end) and pixel offsets from the text's origin
+typedef struct SL_TextLine {
+    int start;
+    int end;
+    int width; // without trailing spaces
+    int baseline;
+} SL_TextLine;
+
+// Counters for everything submitted since the last SL_BeginFrame
+typedef struct SL_FrameStats {
+    int draw_calls; // SDL_RenderGeometry calls
+    int commands; // draws before batching - one per texture per element
+    int elements;
+    int vertices;
+    int indices;
+    int allocations; // heap allocations made by Sliggy
+    int arena_peak; // most bytes of the frame arena in use at once
+    int damage_rects; // retained layer regions redrawn
+} SL_FrameStats;
+
+// Heap bytes Sliggy is holding on to, by what they're for
+typedef struct SL_MemoryStats {
+    size_t text; // text objects - glyph indices, line records and cached geometry
+    size_t elements; // elements and their lookup tables
+    size_t fonts; // glyph data, lookup tables and kerning, or the whole file for mapped fonts
+    size_t names; // interned strings
+    size_t frame; // frame arena
+    size_t textures; // texture memory Sliggy made itself, the sizes of distance field fonts
+    size_t shapes; // shape cache
+} SL_MemoryStats;
+
+// Shape cache totals since SL_Init. Only texts short enough to be cached count as hits or misses
+typedef struct SL_ShapeCacheStats {
+    long long hits;
+    long long misses;
+    long long evictions;
+    int runs;
+    size_t bytes; // held by runs, whether anything's using them or not
+    size_t budget;
+} SL_ShapeCacheStats;
 
 // Builder
 
@@ -24,26 +91,214 @@ void SL_BuilderSetDimensionsAbsolute(SL_UIElementBuilder* builder, const int* x,
 void SL_BuilderSetDimensionsRelative(SL_UIElementBuilder* builder, const float* x, const float* y, const float* w, const float* h);
 void SL_BuilderSetName(SL_UIElementBuilder* builder, const char* path);
 void SL_BuilderSetFont(SL_UIElementBuilder* builder, SDL_Texture* tex, const char* name);
+void SL_BuilderUseFont(SL_UIElementBuilder* builder, SL_Font* font);
 void SL_BuilderSetActive(SL_UIElementBuilder* builder, int active);
+void SL_BuilderSetTextAlign(SL_UIElementBuilder* builder, SL_TextAlign align);
 void SL_BuilderSetTexture(SL_UIElementBuilder* builder, SDL_Texture* texture);
+// Uses part of a texture as the 9-slice skin, like a skin packed into an atlas. NULL region for the whole texture
+void SL_BuilderSetSkinRegion(SL_UIElementBuilder* builder, SDL_Texture* texture, const SDL_Rect* region);
 void SL_BuilderAddTextObject(SL_UIElementBuilder *builder, const char *text, int x_, int y_, float size, const char *id_);
+// Makes the element a virtual list - rows aren't stored anywhere, the callback fills in whichever ones are on screen
+// using the builder's font. Only those get laid out and drawn, and a row's slot is reused once it scrolls off, so
+// 100k rows cost the same as a screenful. Rows are one line each, anything past the row height is cut off
+void SL_BuilderSetList(SL_UIElementBuilder* builder, int row_count, int row_height, float text_size,
+                       SL_ListRowCallback callback, void* userdata);
+// x of each column from the left of the element, one column at 0 by default
+void SL_BuilderSetListColumns(SL_UIElementBuilder* builder, const int* x, int count);
 
 // Element/Core
 
 void SL_Init(SDL_Renderer* renderer, int screen_width_, int screen_height_, int flags);
 void SL_Quit();
 
+// Elements come out of a pool in both memory modes. Freeing one puts its slot and text buffers back for the next
+// element to reuse, so steady churn doesn't allocate. Unmanaged elements still around at SL_Quit are freed there
 SL_UIElement* SL_CreateElement(SL_UIElementBuilder** builder_);
 void SL_FreeElement(SL_UIElement* element);
+// count copies of one builder, which is freed after like with SL_CreateElement
+int SL_CreateElements(SL_UIElementBuilder** builder_, int count, SL_UIElement** out);
+void SL_FreeElements(SL_UIElement* const* elements, int count);
+// Frees the buffers freed slots are holding on to, after a screen full of elements goes away for good
+void SL_TrimElementPool(void);
+
+SL_Handle SL_GetElementHandle(const SL_UIElement* element);
+SL_UIElement* SL_GetElementByHandle(SL_Handle handle);
 
 SL_UIElement* getElementFromMap(const char* name);
+SL_UIElement* SL_GetElementById(SL_Id id);
+SL_Id SL_GetElementId(const SL_UIElement* element);
 
 void SL_DrawElement(const SL_UIElement* element);
+void SL_DrawElementById(SL_Id id);
+
+// Frame
+
+// Elements drawn between these two are batched by texture and flushed together in SL_EndFrame
+void SL_BeginFrame(void);
+void SL_EndFrame(void);
+SL_FrameStats SL_GetFrameStats(void);
+
+// Geometry for a frame goes in one fixed block, a frame that outgrows it is flushed early. Defaults to 2MB
+void SL_SetFrameArenaCapacity(int bytes);
+int SL_GetFrameArenaHighWater(void);
+
+SL_MemoryStats SL_GetMemoryStats(void);
+
+// Short texts are shaped once per font, size and wrap width, and every text showing the same string shares the
+// glyphs and lines - labels and button captions don't get decoded and laid out per element. A text copies them
+// back out the first time it's changed. Runs nothing's using go oldest first past the budget, which defaults to
+// 256KB. 0 turns the cache off
+void SL_SetShapeCacheBudget(size_t bytes);
+SL_ShapeCacheStats SL_GetShapeCacheStats(void);
+
+// Retained mode - every active element is kept in a screen sized layer that's only redrawn where something
+// changed, then composited with one copy. Elements are painted in the order they were created, so a newer one is
+// always on top of an older one it overlaps. Needs SL_FLAGS_MANAGE_MEMORY and render target support
+int SL_SetRetained(int enabled);
+void SL_DrawRetained(void);
+// For changes Sliggy can't see, like a skin texture being updated. NULL damages everything
+void SL_Damage(const SDL_Rect* rect);
 
 int SL_ElementIsActive(const SL_UIElement* element);
 void SL_ActivateElement(SL_UIElement* element);
 void SL_DeactivateElement(SL_UIElement* element);
 
+// Runtime changes - geometry is cached, these only redo the parts they affect
+void SL_SetDimensionsAbsolute(SL_UIElement* element, const int* x, const int* y, const int* w, const int* h);
+void SL_SetSkin(SL_UIElement* element, SDL_Texture* skin);
+void SL_SetSkinRegion(SL_UIElement* element, SDL_Texture* skin, const SDL_Rect* region);
+// Multiplies the skin and text colours, alpha included. Only touches vertex colours, nothing is rebuilt
+void SL_SetTint(SL_UIElement* element, SDL_Color tint);
+void SL_SetTextColor(SL_UIElement* element, const char* id, SDL_Color color);
+void SL_SetTextColorById(SL_UIElement* element, SL_Id id, SDL_Color color);
+void SL_SetTextSize(SL_UIElement* element, const char* id, float size);
+void SL_SetTextSizeById(SL_UIElement* element, SL_Id id, float size);
+void SL_SetTextAlign(SL_UIElement* element, const char* id, SL_TextAlign align);
+// Replaces a text's content. Only the lines the change reaches are laid out and rebuilt, and the buffers are reused
+// while the text fits in them, so a counter updated every frame doesn't allocate
+void SL_SetText(SL_UIElement* element, const char* id, const char* text);
+void SL_SetTextById(SL_UIElement* element, SL_Id id, const char* text);
+
+// Typewriter text - only the first count glyphs of a text are drawn. The cached geometry is just cut short, so a
+// partly shown text costs the same as a static one. A negative count shows everything
+typedef void (*SL_RevealCallback)(SL_UIElement* element, SL_Id id, int index, Uint32 codepoint, void* userdata);
+void SL_SetTextVisibleCount(SL_UIElement* element, const char* id, int count);
+int SL_GetTextVisibleCount(SL_UIElement* element, const char* id);
+// Hides the text then shows chars_per_second glyphs a second as SL_UpdateReveal is called. The callback is optional
+// and runs once for each glyph as it appears
+void SL_RevealText(SL_UIElement* element, const char* id, float chars_per_second, SL_RevealCallback callback, void* userdata);
+// For fast forwarding a reveal that's already going
+void SL_SetRevealSpeed(SL_UIElement* element, const char* id, float chars_per_second);
+// Shows the rest at once without running the callback. A NULL id skips every text in the element
+void SL_SkipReveal(SL_UIElement* element, const char* id);
+// Advances the element's reveals by dt seconds, returns how many are still going
+int SL_UpdateReveal(SL_UIElement* element, float dt);
+
+// Lists - scroll is in pixels from the top of the first row and gets clamped to the end of the list. A row whose
+// content changed needs refreshing, it's only asked for again once it scrolls back on otherwise
+void SL_SetListRowCount(SL_UIElement* element, int row_count);
+int SL_GetListRowCount(const SL_UIElement* element);
+void SL_SetListScroll(SL_UIElement* element, int scroll);
+int SL_GetListScroll(const SL_UIElement* element);
+// Scrolls just far enough for the row to be entirely in view
+void SL_ScrollListTo(SL_UIElement* element, int row);
+void SL_RefreshListRow(SL_UIElement* element, int row);
+void SL_RefreshList(SL_UIElement* element);
+
+// Text layout happens lazily on draw, this does it up front for anything that's out of date
+void SL_LayoutText(SL_UIElement* element);
+// Job pool for text layout and geometry. count is threads in total, including the caller, 1 (the default) keeps
+// everything on the calling thread. Only Sliggy's own work runs on it, no SDL calls
+int SL_SetJobThreads(int count);
+int SL_GetJobThreads(void);
+// Brings the text of every element up to date, one job per element spread over the pool, so drawing them after
+// is just copying. Each element should only be in the list once. The retained layer does this by itself
+void SL_PrepareElements(SL_UIElement* const* elements, int count);
+const SL_TextLine* SL_GetTextLines(SL_UIElement* element, const char* id, int* count);
+
+// Fonts
+
+// Fonts are shared by path - loading one that's already loaded just adds a reference. Text added to a builder uses the font set at that point.
+// A texture given for a font that was loaded without one is attached to it, a different texture from the one it
+// already has is an error (NULL, SDL error set). Fonts packed into an atlas keep drawing from the atlas either way
+SL_Font* SL_LoadFont(SDL_Texture* tex, const char* path);
+void SL_RetainFont(SL_Font* font);
+void SL_ReleaseFont(SL_Font* font);
+SDL_Texture* SL_FontTexture(const SL_Font* font);
+// On by default for fonts that have kerning pairs
+void SL_FontSetKerning(SL_Font* font, int enabled);
+
+// Writes a .fnt as a binary font that SL_BuilderSetFont can map directly. Returns 0 on success, -1 and sets the SDL error otherwise
+int SL_CompileFont(const char* fnt_path, const char* out_path);
+
+// Distance field fonts - a .fnt with a distanceField line (sdf or msdf, as msdf-bmfont or sliggy_sdfc write them) and
+// its atlas, which is only read during the call. One atlas covers every size: each size in use gets a small texture
+// antialiased for it, made when text first asks for it. Kept around for a while after nothing uses them
+SL_Font* SL_LoadSdfFont(SDL_Surface* atlas, const char* path);
+// Writes a generated atlas to path, 0 on success like SDL_SaveBMP
+typedef int (*SL_SurfaceSaver)(SDL_Surface* surface, const char* path, void* userdata);
+// Turns a bitmap font into a distance field one for SL_LoadSdfFont. spread is how many pixels the field reaches past
+// the outlines. Saves the atlas to out_page with saver (bmp when NULL), then writes out_fnt pointing at it. Both are
+// replaced whole, the atlas first, so hot reload never picks up a .fnt without its page. Returns the atlas, NULL and
+// sets the SDL error on failure
+SDL_Surface* SL_GenerateSdfFont(const char* fnt_path, SDL_Surface* page, int spread, const char* out_fnt,
+                                const char* out_page, SL_SurfaceSaver saver, void* userdata);
+
+// Blueprints
+
+// Turns an image path from a blueprint into a texture. The textures stay yours to destroy. Each path is only asked
+// for once until SL_Quit, or again when hot reload sees it change
+typedef SDL_Texture* (*SL_TextureLoader)(const char* path, void* userdata);
+
+/*
+ * Creates every element a blueprint describes, from the text form or a compiled one. Needs SL_FLAGS_MANAGE_MEMORY,
+ * the elements are found by name afterwards. Text form, one record per line, quotes for values with spaces:
+ *
+ *   blueprint elements=100 texts=200
+ *   skin name=panel path=bad_aa_9.png region=0,0,96,96
+ *   font name=main path=Font2.fnt texture=Font2.png
+ *   element name=dialog skin=panel font=main rect=50,50,300,300 align=center active=1
+ *   text id=line1 x=8 y=16 size=16 color=255,255,0 value="Hello World!"
+ *
+ * The blueprint line is optional and only lets storage be set aside up front. rel=0.25,0.5,0.5,0.25 is the relative
+ * version of rect. Texts belong to the element above them, fonts and skins have to come before they're used.
+ * Returns how many elements were created, or -1 and sets the SDL error - elements created before the error stay
+ */
+int SL_LoadBlueprint(const char* path, SL_TextureLoader loader, void* userdata);
+// Writes a text blueprint in the compiled form, which loads without any parsing. Returns 0 on success
+int SL_CompileBlueprint(const char* bp_path, const char* out_path);
+
+/*
+ * Hot reload - watches every font, blueprint and blueprint image loaded before or after this, and redoes only what
+ * a changed file affects. Files are parsed on a background thread and swapped in by SL_BeginFrame. Elements keep
+ * their address and whether they're active, a reloaded blueprint rebuilds its named elements in place and creates
+ * any new ones. Images go back through the blueprint's texture loader. Needs SL_FLAGS_MANAGE_MEMORY, Linux only for now
+ */
+int SL_EnableHotReload(void);
+void SL_DisableHotReload(void);
+
+// Atlases
+
+// Packs skins and font pages into shared textures at load time, so panels and their text can go out in one draw call.
+// Surfaces are only read by SL_BuildAtlas, free them whenever after that
+SL_Atlas* SL_CreateAtlas(int page_width, int page_height);
+int SL_AtlasAddSkin(SL_Atlas* atlas, const char* name, SDL_Surface* surface);
+// The font draws from the atlas once it's built. page is the surface of the font's texture
+int SL_AtlasAddFont(SL_Atlas* atlas, SL_Font* font, SDL_Surface* page);
+// Returns 0 on success, -1 and sets the SDL error otherwise
+int SL_BuildAtlas(SL_Atlas* atlas);
+// The page texture holding the skin and where on it, for SL_BuilderSetSkinRegion. NULL if there's no such skin
+SDL_Texture* SL_AtlasGetSkin(const SL_Atlas* atlas, const char* name, SDL_Rect* region);
+int SL_AtlasPageCount(const SL_Atlas* atlas);
+// Destroys the page textures - free anything drawing from them first, and call it before SL_Quit
+void SL_FreeAtlas(SL_Atlas* atlas);
+
+// Names
+
+// Returns the same id for equal strings until SL_Quit. Names and text ids passed to the builder are interned for you
+SL_Id SL_Intern(const char* name);
+const char* SL_IdName(SL_Id id);
+
 #ifdef __cplusplus
 }
 #endif
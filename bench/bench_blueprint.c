@@ -0,0 +1,126 @@
+//
+// Blueprint load times - the same screen built through the builder functions, a text blueprint and a compiled one
+//
+// sliggy_bench_blueprint [rounds]
+//
+
+#include "bench_common.h"
+#include "Sliggy.h"
+#include <string.h>
+
+#define SCREEN_W 1280
+#define SCREEN_H 720
+#define TEXTS_PER_ELEMENT 2
+#define TEXT_PATH "bench_blueprint.bp"
+#define COMPILED_PATH "bench_blueprint.slbp"
+
+static SDL_Renderer* renderer;
+static SDL_Texture* skin;
+static SDL_Texture* font_tex;
+
+static SDL_Texture* loadTexture(const char* path, void* userdata) {
+    (void)userdata;
+    return strstr(path, "Font") ? font_tex : skin;
+}
+
+static int writeBlueprint(int n) {
+    FILE* file = fopen(TEXT_PATH, "w");
+    if (!file) return -1;
+    fprintf(file, "blueprint elements=%d texts=%d\n", n, n * TEXTS_PER_ELEMENT);
+    fprintf(file, "skin name=panel path=bad_aa_9.png\n");
+    fprintf(file, "font name=main path=\"%s\" texture=Font2.png\n", BENCH_FONT_PATH);
+    for (int e = 0; e < n; e++) {
+        fprintf(file, "element name=panel_%d skin=panel font=main rect=%d,%d,200,80\n", e, (e * 37) % SCREEN_W, (e * 53) % SCREEN_H);
+        fprintf(file, "text id=title x=8 y=8 size=16 value=\"Panel %d\"\n", e);
+        fprintf(file, "text id=body x=8 y=32 size=8 color=200,200,200 value=\"Some words about panel %d\"\n", e);
+    }
+    fclose(file);
+    return 0;
+}
+
+static void buildDirect(int n) {
+    SL_Font* font = SL_LoadFont(font_tex, BENCH_FONT_PATH);
+    char name[32];
+    char title[32];
+    char body[64];
+    SDL_Color grey = {200, 200, 200, 255};
+    for (int e = 0; e < n; e++) {
+        snprintf(name, sizeof(name), "panel_%d", e);
+        snprintf(title, sizeof(title), "Panel %d", e);
+        snprintf(body, sizeof(body), "Some words about panel %d", e);
+        SL_UIElementBuilder* b = SL_CreateBuilder(skin);
+        int x = (e * 37) % SCREEN_W, y = (e * 53) % SCREEN_H, w = 200, h = 80;
+        SL_BuilderSetDimensionsAbsolute(b, &x, &y, &w, &h);
+        SL_BuilderSetName(b, name);
+        SL_BuilderUseFont(b, font);
+        SL_BuilderAddTextObject(b, title, 8, 8, 16, "title");
+        SL_BuilderAddTextObject(b, body, 8, 32, 8, "body");
+        SL_UIElement* element = SL_CreateElement(&b);
+        SL_SetTextColor(element, "body", grey);
+    }
+    SL_ReleaseFont(font);
+}
+
+// Best of a few rounds, each from a clean SL_Init. Allocations are from the last round
+static double timeLoad(int n, int rounds, const char* path, int* allocations) {
+    double best = 1e30;
+    for (int r = 0; r < rounds; r++) {
+        SL_Init(renderer, SCREEN_W, SCREEN_H, SL_FLAGS_MANAGE_MEMORY);
+        SL_BeginFrame();
+        double start = benchNow();
+        if (path) {
+            if (SL_LoadBlueprint(path, loadTexture, NULL) != n) {
+                fprintf(stderr, "Couldn't load %s: %s\n", path, SDL_GetError());
+                exit(1);
+            }
+        }
+        else {
+            buildDirect(n);
+        }
+        double end = benchNow();
+        *allocations = SL_GetFrameStats().allocations;
+        SL_EndFrame();
+        SL_Quit();
+        if (end - start < best) best = end - start;
+    }
+    return best;
+}
+
+static void runSize(int n, int rounds) {
+    if (writeBlueprint(n) != 0 || SL_CompileBlueprint(TEXT_PATH, COMPILED_PATH) != 0) {
+        fprintf(stderr, "Couldn't write the blueprints: %s\n", SDL_GetError());
+        exit(1);
+    }
+
+    int direct_allocs, text_allocs, compiled_allocs;
+    double direct = timeLoad(n, rounds, NULL, &direct_allocs);
+    double text = timeLoad(n, rounds, TEXT_PATH, &text_allocs);
+    double compiled = timeLoad(n, rounds, COMPILED_PATH, &compiled_allocs);
+
+    printf("%6d elements x %d texts\n", n, TEXTS_PER_ELEMENT);
+    printf("  builder calls   %8.2f ms  %6.2f us/element  %7d allocations\n", direct * 1e3, direct / n * 1e6, direct_allocs);
+    printf("  text blueprint  %8.2f ms  %6.2f us/element  %7d allocations\n", text * 1e3, text / n * 1e6, text_allocs);
+    printf("  compiled        %8.2f ms  %6.2f us/element  %7d allocations\n", compiled * 1e3, compiled / n * 1e6, compiled_allocs);
+
+    remove(TEXT_PATH);
+    remove(COMPILED_PATH);
+}
+
+int main(int argc, char** argv) {
+    int rounds = argc > 1 ? atoi(argv[1]) : 5;
+    if (rounds <= 0) rounds = 5;
+
+    SDL_Surface* surface;
+    renderer = benchCreateRenderer(SCREEN_W, SCREEN_H, &surface);
+    skin = benchCreateTexture(renderer, 96, 96);
+    font_tex = benchCreateTexture(renderer, 512, 512);
+
+    runSize(1000, rounds);
+    runSize(10000, rounds);
+
+    SDL_DestroyTexture(skin);
+    SDL_DestroyTexture(font_tex);
+    SDL_DestroyRenderer(renderer);
+    SDL_FreeSurface(surface);
+    return 0;
+}
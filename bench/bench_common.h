@@ -0,0 +1,44 @@
+//
+// Shared helpers for the benchmark executables
+//
+
+#ifndef SLIGGY_BENCH_COMMON_H
+#define SLIGGY_BENCH_COMMON_H
+
+#include "SDL.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifndef SLIGGY_ASSET_DIR
+#define SLIGGY_ASSET_DIR ".."
+#endif
+
+#define BENCH_FONT_PATH SLIGGY_ASSET_DIR "/Font2.fnt"
+#define BENCH_FONT_TEXTURE_PATH SLIGGY_ASSET_DIR "/Font2.png"
+#define BENCH_SKIN_PATH SLIGGY_ASSET_DIR "/bad_aa_9.png"
+
+static inline double benchNow(void) {
+    return (double)SDL_GetPerformanceCounter() / (double)SDL_GetPerformanceFrequency();
+}
+
+// Software renderer drawing into a plain surface - no window or video driver needed
+static inline SDL_Renderer* benchCreateRenderer(int w, int h, SDL_Surface** surface) {
+    *surface = SDL_CreateRGBSurfaceWithFormat(0, w, h, 32, SDL_PIXELFORMAT_RGBA32);
+    if (!*surface) {
+        fprintf(stderr, "Couldn't create surface: %s\n", SDL_GetError());
+        exit(1);
+    }
+    SDL_Renderer* renderer = SDL_CreateSoftwareRenderer(*surface);
+    if (!renderer) {
+        fprintf(stderr, "Couldn't create renderer: %s\n", SDL_GetError());
+        exit(1);
+    }
+    return renderer;
+}
+
+// Blank stand-ins for bad_aa_9.png/Font2.png, the benchmarks only care about geometry
+static inline SDL_Texture* benchCreateTexture(SDL_Renderer* renderer, int w, int h) {
+    return SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STATIC, w, h);
+}
+
+#endif //SLIGGY_BENCH_COMMON_H
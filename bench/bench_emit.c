@@ -0,0 +1,118 @@
+//
+// Glyphs per second through text layout and quad generation, for big text screens (credits, logs, chat), and what
+// a typewriter reveal costs per draw next to the same text left alone
+//
+
+#include "bench_common.h"
+#include "Sliggy.h"
+
+#define SCREEN_W 1280
+#define SCREEN_H 720
+#define NUM_TEXTS 16
+#define GLYPHS_PER_TEXT 2000
+#define WARMUP_ROUNDS 5
+
+static const char* text_ids[NUM_TEXTS] = {
+        "t0", "t1", "t2", "t3", "t4", "t5", "t6", "t7", "t8", "t9", "t10", "t11", "t12", "t13", "t14", "t15"
+};
+
+// Dirties every text then times the draw that rebuilds them. Returns glyphs per second
+static double runRounds(SL_UIElement* element, int rounds, int relayout) {
+    double total = 0;
+
+    for (int r = 0; r < rounds + WARMUP_ROUNDS; r++) {
+        for (int t = 0; t < NUM_TEXTS; t++) {
+            // A new size needs the lines redone, a new alignment only the quads
+            if (relayout) {
+                SL_SetTextSize(element, text_ids[t], (r & 1) ? 8.0f : 9.0f);
+            }
+            else {
+                SL_SetTextAlign(element, text_ids[t], (r & 1) ? SL_TEXT_ALIGN_RIGHT : SL_TEXT_ALIGN_LEFT);
+            }
+        }
+
+        SL_BeginFrame();
+        double start = benchNow();
+        SL_DrawElement(element);
+        double end = benchNow();
+        SL_EndFrame();
+
+        if (r >= WARMUP_ROUNDS) {
+            total += end - start;
+        }
+    }
+    return (double)NUM_TEXTS * GLYPHS_PER_TEXT * rounds / total;
+}
+
+// Microseconds per draw with nothing changing, or with every text mid reveal, going from empty to full over the rounds
+static double runDraws(SL_UIElement* element, int rounds, int reveal) {
+    double total = 0;
+
+    for (int r = 0; r < rounds + WARMUP_ROUNDS; r++) {
+        if (reveal) {
+            if (r == WARMUP_ROUNDS) {
+                for (int t = 0; t < NUM_TEXTS; t++) {
+                    SL_RevealText(element, text_ids[t], (float)GLYPHS_PER_TEXT, NULL, NULL);
+                }
+            }
+            SL_UpdateReveal(element, 1.0f / (float)rounds);
+        }
+
+        SL_BeginFrame();
+        double start = benchNow();
+        SL_DrawElement(element);
+        double end = benchNow();
+        SL_EndFrame();
+
+        if (r >= WARMUP_ROUNDS) {
+            total += end - start;
+        }
+    }
+    return total * 1e6 / rounds;
+}
+
+int main(int argc, char** argv) {
+    int rounds = argc > 1 ? atoi(argv[1]) : 100;
+    if (rounds <= 0) rounds = 100;
+
+    SDL_Surface* surface;
+    SDL_Renderer* renderer = benchCreateRenderer(SCREEN_W, SCREEN_H, &surface);
+    SL_Init(renderer, SCREEN_W, SCREEN_H, 0);
+    // Room for the whole screen, so no early flush lands inside the timed draw
+    SL_SetFrameArenaCapacity(32 << 20);
+
+    SDL_Texture* skin = benchCreateTexture(renderer, 96, 96);
+    SDL_Texture* font = benchCreateTexture(renderer, 512, 512);
+
+    char text[GLYPHS_PER_TEXT + 1];
+    for (int i = 0; i < GLYPHS_PER_TEXT; i++) {
+        text[i] = (i % 7 == 6) ? ' ' : (char)('a' + (i * 7) % 26);
+    }
+    text[GLYPHS_PER_TEXT] = '\0';
+
+    SL_UIElementBuilder* b = SL_CreateBuilder(skin);
+    int x = 0, y = 0, w = SCREEN_W, h = SCREEN_H;
+    SL_BuilderSetDimensionsAbsolute(b, &x, &y, &w, &h);
+    SL_BuilderSetFont(b, font, BENCH_FONT_PATH);
+    for (int t = 0; t < NUM_TEXTS; t++) {
+        SL_BuilderAddTextObject(b, text, 4, 4 + t * 44, 8, text_ids[t]);
+    }
+    SL_UIElement* element = SL_CreateElement(&b);
+
+    double emit = runRounds(element, rounds, 0);
+    double layout = runRounds(element, rounds, 1);
+    double still = runDraws(element, rounds, 0);
+    double reveal = runDraws(element, rounds, 1);
+
+    printf("%d texts x %d glyphs, %d rounds\n", NUM_TEXTS, GLYPHS_PER_TEXT, rounds);
+    printf("  emit only       %8.2f M glyphs/s\n", emit / 1e6);
+    printf("  layout + emit   %8.2f M glyphs/s\n", layout / 1e6);
+    printf("  static draw     %8.2f us\n", still);
+    printf("  reveal draw     %8.2f us (half the glyphs on average)\n", reveal);
+
+    SL_FreeElement(element);
+    SL_Quit();
+    SDL_DestroyRenderer(renderer);
+    SDL_FreeSurface(surface);
+    return 0;
+}
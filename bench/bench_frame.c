@@ -0,0 +1,241 @@
+//
+// Frame-time harness - draws a scene of N elements x M text objects headless and reports per-frame numbers
+//
+// sliggy_bench [-e elements] [-t texts per element] [-f frames] [-w warmup frames] [-a arena bytes] [-m count] [-r] [-x]
+//   -m moves that many elements each frame (-1 for all), so their cached text geometry gets rebuilt
+//   -r draws through the retained layer, only redrawing what moved
+//   -x packs the skin and font page into one atlas so panels and text share a texture
+//
+
+#include "bench_common.h"
+#include "Sliggy.h"
+#include <string.h>
+
+#ifdef SLIGGY_HAVE_SDL_IMAGE
+#include "SDL_image.h"
+#endif
+
+#define SCREEN_W 1280
+#define SCREEN_H 720
+#define TEXT_SIZE 8
+
+typedef struct BenchOptions {
+    int elements;
+    int texts;
+    int frames;
+    int warmup;
+    int arena;
+    int move;
+    int retained;
+    int atlas;
+} BenchOptions;
+
+static void usage(const char* exe) {
+    fprintf(stderr, "Usage: %s [-e elements] [-t texts per element] [-f frames] [-w warmup frames] [-a arena bytes] [-m count] [-r] [-x]\n", exe);
+    exit(1);
+}
+
+static BenchOptions parseOptions(int argc, char** argv) {
+    BenchOptions opts = {100, 4, 500, 20, 0, 0, 0, 0};
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-r") == 0) {
+            opts.retained = 1;
+            continue;
+        }
+        if (strcmp(argv[i], "-x") == 0) {
+            opts.atlas = 1;
+            continue;
+        }
+        if (i + 1 >= argc) usage(argv[0]);
+        int val = atoi(argv[i + 1]);
+        if (strcmp(argv[i], "-e") == 0) opts.elements = val;
+        else if (strcmp(argv[i], "-t") == 0) opts.texts = val;
+        else if (strcmp(argv[i], "-f") == 0) opts.frames = val;
+        else if (strcmp(argv[i], "-w") == 0) opts.warmup = val;
+        else if (strcmp(argv[i], "-a") == 0) opts.arena = val;
+        else if (strcmp(argv[i], "-m") == 0) opts.move = val;
+        else usage(argv[0]);
+        i++;
+    }
+    if (opts.move < 0 || opts.move > opts.elements) opts.move = opts.elements;
+    if (opts.elements <= 0 || opts.texts < 0 || opts.frames <= 0 || opts.warmup < 0) usage(argv[0]);
+    return opts;
+}
+
+// The real art when SDL_image is around, otherwise blank textures the same size
+static SDL_Texture* loadTexture(SDL_Renderer* renderer, const char* path, int w, int h) {
+#ifdef SLIGGY_HAVE_SDL_IMAGE
+    SDL_Texture* tex = IMG_LoadTexture(renderer, path);
+    if (tex) return tex;
+    fprintf(stderr, "Couldn't load %s (%s), using a blank texture\n", path, SDL_GetError());
+#else
+    (void)path;
+#endif
+    return benchCreateTexture(renderer, w, h);
+}
+
+// Same as loadTexture, for the atlas to pack
+static SDL_Surface* loadSurface(const char* path, int w, int h) {
+#ifdef SLIGGY_HAVE_SDL_IMAGE
+    SDL_Surface* surface = IMG_Load(path);
+    if (surface) return surface;
+    fprintf(stderr, "Couldn't load %s (%s), using a blank surface\n", path, SDL_GetError());
+#else
+    (void)path;
+#endif
+    return SDL_CreateRGBSurfaceWithFormat(0, w, h, 32, SDL_PIXELFORMAT_RGBA32);
+}
+
+static int compareDoubles(const void* a, const void* b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static double percentile(const double* sorted, int count, double p) {
+    int i = (int)(p * (double)(count - 1) + 0.5);
+    return sorted[i];
+}
+
+int main(int argc, char** argv) {
+    BenchOptions opts = parseOptions(argc, argv);
+
+    // Nothing gets shown, but going through SDL_Init keeps this honest about what a real app pays for
+    SDL_setenv("SDL_VIDEODRIVER", "dummy", 0);
+    if (SDL_Init(SDL_INIT_VIDEO) != 0) {
+        fprintf(stderr, "Couldn't init SDL: %s\n", SDL_GetError());
+        return 1;
+    }
+#ifdef SLIGGY_HAVE_SDL_IMAGE
+    IMG_Init(IMG_INIT_PNG);
+#endif
+
+    SDL_Surface* surface;
+    SDL_Renderer* renderer = benchCreateRenderer(SCREEN_W, SCREEN_H, &surface);
+    SL_Init(renderer, SCREEN_W, SCREEN_H, SL_FLAGS_MANAGE_MEMORY);
+    if (opts.arena > 0) {
+        SL_SetFrameArenaCapacity(opts.arena);
+    }
+    if (opts.retained && SL_SetRetained(1) != 0) {
+        fprintf(stderr, "Couldn't enable retained mode: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    SDL_Texture* skin = NULL;
+    SDL_Texture* font_tex = NULL;
+    SL_Atlas* atlas = NULL;
+    SDL_Rect skin_region = {0, 0, 0, 0};
+    if (!opts.atlas) {
+        skin = loadTexture(renderer, BENCH_SKIN_PATH, 96, 96);
+        font_tex = loadTexture(renderer, BENCH_FONT_TEXTURE_PATH, 512, 512);
+    }
+    SL_Font* font = SL_LoadFont(font_tex, BENCH_FONT_PATH);
+    if (!font) {
+        fprintf(stderr, "Couldn't load font: %s\n", SDL_GetError());
+        return 1;
+    }
+    if (opts.atlas) {
+        SDL_Surface* skin_surface = loadSurface(BENCH_SKIN_PATH, 96, 96);
+        SDL_Surface* font_surface = loadSurface(BENCH_FONT_TEXTURE_PATH, 512, 512);
+        atlas = SL_CreateAtlas(1024, 1024);
+        if (SL_AtlasAddSkin(atlas, "skin", skin_surface) != 0 || SL_AtlasAddFont(atlas, font, font_surface) != 0
+            || SL_BuildAtlas(atlas) != 0) {
+            fprintf(stderr, "Couldn't build the atlas: %s\n", SDL_GetError());
+            return 1;
+        }
+        SDL_FreeSurface(skin_surface);
+        SDL_FreeSurface(font_surface);
+        skin = SL_AtlasGetSkin(atlas, "skin", &skin_region);
+    }
+
+    // Elements tile the screen in a square-ish grid, overlapping once there are too many to fit
+    int cols = 1;
+    while (cols * cols < opts.elements) cols++;
+    int rows = (opts.elements + cols - 1) / cols;
+    int cell_w = SCREEN_W / cols > 64 ? SCREEN_W / cols : 64;
+    int cell_h = SCREEN_H / rows > 48 ? SCREEN_H / rows : 48;
+    int line_h = (cell_h - 8) / (opts.texts ? opts.texts : 1);
+
+    SL_UIElement** elements = malloc(opts.elements * sizeof(SL_UIElement*));
+    char id[16];
+    for (int e = 0; e < opts.elements; e++) {
+        SL_UIElementBuilder* b = SL_CreateBuilder(skin);
+        if (atlas) {
+            SL_BuilderSetSkinRegion(b, skin, &skin_region);
+        }
+        int x = (e % cols) * SCREEN_W / cols;
+        int y = (e / cols) * SCREEN_H / rows;
+        int w = cell_w;
+        int h = cell_h;
+        SL_BuilderSetDimensionsAbsolute(b, &x, &y, &w, &h);
+        SL_BuilderUseFont(b, font);
+        for (int t = 0; t < opts.texts; t++) {
+            snprintf(id, sizeof(id), "t%d", t);
+            SL_BuilderAddTextObject(b, "Sliggy bench 0123456789", 4, 4 + t * line_h, TEXT_SIZE, id);
+        }
+        elements[e] = SL_CreateElement(&b);
+    }
+
+    int total_frames = opts.frames + opts.warmup;
+    double* times = malloc(opts.frames * sizeof(double));
+    SL_FrameStats last = {0};
+    long long allocations = 0;
+
+    for (int f = 0; f < total_frames; f++) {
+        double start = benchNow();
+
+        SDL_RenderClear(renderer);
+        SL_BeginFrame();
+        for (int e = 0; e < opts.move; e++) {
+            int x = (e % cols) * SCREEN_W / cols + (f & 7);
+            SL_SetDimensionsAbsolute(elements[e], &x, NULL, NULL, NULL);
+        }
+        if (opts.retained) {
+            SL_DrawRetained();
+        }
+        else {
+            for (int e = 0; e < opts.elements; e++) {
+                SL_DrawElement(elements[e]);
+            }
+        }
+        SL_EndFrame();
+        SDL_RenderPresent(renderer);
+
+        double end = benchNow();
+        if (f >= opts.warmup) {
+            times[f - opts.warmup] = (end - start) * 1e3;
+            last = SL_GetFrameStats();
+            allocations += last.allocations;
+        }
+    }
+
+    qsort(times, opts.frames, sizeof(double), compareDoubles);
+    double total = 0;
+    for (int i = 0; i < opts.frames; i++) total += times[i];
+
+    printf("%d elements x %d texts, %d frames, %d moving%s%s\n", opts.elements, opts.texts, opts.frames, opts.move,
+           opts.retained ? ", retained" : "", opts.atlas ? ", atlas" : "");
+    printf("  frame ms    p50 %.3f  p99 %.3f  mean %.3f  max %.3f\n",
+           percentile(times, opts.frames, 0.5), percentile(times, opts.frames, 0.99),
+           total / opts.frames, times[opts.frames - 1]);
+    printf("  per frame   draw calls %d  commands %d  vertices %d  indices %d  elements drawn %d  damage rects %d\n",
+           last.draw_calls, last.commands, last.vertices, last.indices, last.elements, last.damage_rects);
+    printf("  allocations %.2f per frame (%lld total)\n", (double)allocations / opts.frames, allocations);
+    printf("  arena       high water %d bytes\n", SL_GetFrameArenaHighWater());
+    SL_MemoryStats mem = SL_GetMemoryStats();
+    printf("  memory KB   text %.1f  elements %.1f  fonts %.1f  names %.1f  frame %.1f\n",
+           mem.text / 1024.0, mem.elements / 1024.0, mem.fonts / 1024.0, mem.names / 1024.0, mem.frame / 1024.0);
+
+    free(times);
+    free(elements);
+    SL_ReleaseFont(font);
+    SL_FreeAtlas(atlas);
+    SL_Quit();
+    SDL_DestroyRenderer(renderer);
+    SDL_FreeSurface(surface);
+#ifdef SLIGGY_HAVE_SDL_IMAGE
+    IMG_Quit();
+#endif
+    SDL_Quit();
+    return 0;
+}
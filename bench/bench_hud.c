@@ -0,0 +1,161 @@
+//
+// HUD counters changing every frame - SL_SetText against rebuilding the element, plus one word changing in the
+// middle of a long wrapped paragraph, which only needs the lines around it redone
+//
+// sliggy_bench_hud [frames]
+//
+
+#include "bench_common.h"
+#include "Sliggy.h"
+#include <string.h>
+
+#define SCREEN_W 1280
+#define SCREEN_H 720
+#define NUM_COUNTERS 32
+#define PARAGRAPH_WORDS 400
+#define WARMUP_FRAMES 20
+
+static const char* counter_ids[] = {"fps", "score", "timer"};
+
+static SL_UIElementBuilder* counterBuilder(SDL_Texture* skin, SL_Font* font, int i, const char** texts) {
+    SL_UIElementBuilder* b = SL_CreateBuilder(skin);
+    int x = (i % 8) * 160, y = (i / 8) * 60, w = 150, h = 50;
+    SL_BuilderSetDimensionsAbsolute(b, &x, &y, &w, &h);
+    SL_BuilderUseFont(b, font);
+    for (int t = 0; t < 3; t++) {
+        SL_BuilderAddTextObject(b, texts[t], 4, 4 + t * 14, 8, counter_ids[t]);
+    }
+    return b;
+}
+
+typedef struct RunResult {
+    double us;
+    double allocations;
+} RunResult;
+
+static void counterTexts(int frame, int i, char bufs[3][32], const char** texts) {
+    snprintf(bufs[0], 32, "FPS %3d", 55 + (frame + i) % 10);
+    snprintf(bufs[1], 32, "Score %08d", frame * 37 + i);
+    snprintf(bufs[2], 32, "%02d:%02d.%02d", frame / 3600 % 60, frame / 60 % 60, frame % 60);
+    for (int t = 0; t < 3; t++) texts[t] = bufs[t];
+}
+
+// Microseconds a frame updating every counter then drawing, either through SL_SetText or by replacing the element
+static RunResult runCounters(SL_UIElement** counters, SDL_Texture* skin, SL_Font* font, int frames, int rebuild) {
+    RunResult result = {0, 0};
+    char bufs[3][32];
+    const char* texts[3];
+    for (int f = 0; f < frames + WARMUP_FRAMES; f++) {
+        SL_BeginFrame();
+        double start = benchNow();
+        for (int i = 0; i < NUM_COUNTERS; i++) {
+            counterTexts(f, i, bufs, texts);
+            if (rebuild) {
+                SL_UIElementBuilder* b = counterBuilder(skin, font, i, texts);
+                SL_FreeElement(counters[i]);
+                counters[i] = SL_CreateElement(&b);
+            }
+            else {
+                for (int t = 0; t < 3; t++) {
+                    SL_SetText(counters[i], counter_ids[t], texts[t]);
+                }
+            }
+            SL_DrawElement(counters[i]);
+        }
+        double end = benchNow();
+        SL_EndFrame();
+        if (f >= WARMUP_FRAMES) {
+            result.us += end - start;
+            result.allocations += SL_GetFrameStats().allocations;
+        }
+    }
+    result.us = result.us * 1e6 / frames;
+    result.allocations /= frames;
+    return result;
+}
+
+// One word in the middle swaps between two spellings each frame. relayout forces the whole thing to be redone
+static RunResult runParagraph(SL_UIElement* panel, char* text, int word_at, int frames, int relayout) {
+    RunResult result = {0, 0};
+    for (int f = 0; f < frames + WARMUP_FRAMES; f++) {
+        memcpy(text + word_at, (f & 1) ? "gamma" : "delta", 5);
+        SL_BeginFrame();
+        double start = benchNow();
+        SL_SetText(panel, "log", text);
+        if (relayout) {
+            SL_SetTextSize(panel, "log", 8.0f);
+        }
+        SL_DrawElement(panel);
+        double end = benchNow();
+        SL_EndFrame();
+        if (f >= WARMUP_FRAMES) {
+            result.us += end - start;
+            result.allocations += SL_GetFrameStats().allocations;
+        }
+    }
+    result.us = result.us * 1e6 / frames;
+    result.allocations /= frames;
+    return result;
+}
+
+int main(int argc, char** argv) {
+    int frames = argc > 1 ? atoi(argv[1]) : 500;
+    if (frames <= 0) frames = 500;
+
+    SDL_Surface* surface;
+    SDL_Renderer* renderer = benchCreateRenderer(SCREEN_W, SCREEN_H, &surface);
+    SL_Init(renderer, SCREEN_W, SCREEN_H, SL_FLAGS_MANAGE_MEMORY);
+
+    SDL_Texture* skin = benchCreateTexture(renderer, 96, 96);
+    SDL_Texture* font_tex = benchCreateTexture(renderer, 512, 512);
+    SL_Font* font = SL_LoadFont(font_tex, BENCH_FONT_PATH);
+    if (!font) {
+        fprintf(stderr, "Couldn't load font: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    SL_UIElement* counters[NUM_COUNTERS];
+    char bufs[3][32];
+    const char* texts[3];
+    for (int i = 0; i < NUM_COUNTERS; i++) {
+        counterTexts(0, i, bufs, texts);
+        SL_UIElementBuilder* b = counterBuilder(skin, font, i, texts);
+        counters[i] = SL_CreateElement(&b);
+    }
+
+    printf("%d counter panels x 3 texts, %d frames\n", NUM_COUNTERS, frames);
+    RunResult rebuilt = runCounters(counters, skin, font, frames, 1);
+    printf("  rebuild element  %8.2f us/frame  %7.2f allocations/frame\n", rebuilt.us, rebuilt.allocations);
+    RunResult set = runCounters(counters, skin, font, frames, 0);
+    printf("  SL_SetText       %8.2f us/frame  %7.2f allocations/frame\n", set.us, set.allocations);
+
+    // "alpha beta delta ..." wrapped to a narrow panel, with the word being changed about half way through
+    char* text = malloc(PARAGRAPH_WORDS * 6 + 1);
+    for (int i = 0; i < PARAGRAPH_WORDS; i++) {
+        memcpy(text + i * 6, i % 3 == 0 ? "alpha " : (i % 3 == 1 ? "beta  " : "delta "), 6);
+    }
+    text[PARAGRAPH_WORDS * 6 - 1] = '\0';
+    int word_at = (PARAGRAPH_WORDS / 2 / 3 * 3 + 2) * 6;
+
+    SL_UIElementBuilder* b = SL_CreateBuilder(skin);
+    int x = 0, y = 0, w = 300, h = SCREEN_H;
+    SL_BuilderSetDimensionsAbsolute(b, &x, &y, &w, &h);
+    SL_BuilderUseFont(b, font);
+    SL_BuilderAddTextObject(b, text, 4, 4, 8, "log");
+    SL_UIElement* panel = SL_CreateElement(&b);
+    int lines;
+    SL_GetTextLines(panel, "log", &lines);
+
+    printf("%d word paragraph over %d lines, one word changing\n", PARAGRAPH_WORDS, lines);
+    RunResult full = runParagraph(panel, text, word_at, frames, 1);
+    printf("  full relayout    %8.2f us/frame  %7.2f allocations/frame\n", full.us, full.allocations);
+    RunResult incremental = runParagraph(panel, text, word_at, frames, 0);
+    printf("  SL_SetText       %8.2f us/frame  %7.2f allocations/frame\n", incremental.us, incremental.allocations);
+
+    free(text);
+    SL_ReleaseFont(font);
+    SL_Quit();
+    SDL_DestroyRenderer(renderer);
+    SDL_FreeSurface(surface);
+    return 0;
+}
@@ -0,0 +1,121 @@
+//
+// Text layout and geometry on the job pool at 1, 2, 4 and 8 threads, for screens that relayout a lot of lines
+// every frame (chat, logs). The checksum has to match across thread counts
+//
+
+#include "bench_common.h"
+#include "Sliggy.h"
+
+#define SCREEN_W 1280
+#define SCREEN_H 720
+#define NUM_ELEMENTS 64
+#define TEXTS_PER_ELEMENT 4
+#define GLYPHS_PER_TEXT 1500
+#define WARMUP_ROUNDS 5
+
+static const int thread_counts[] = {1, 2, 4, 8};
+static const char* text_ids[TEXTS_PER_ELEMENT] = {"t0", "t1", "t2", "t3"};
+
+// Mixes every line of every text in with the drawn pixels, so a difference in layout or geometry shows up
+static Uint32 checksum(SL_UIElement** elements, SDL_Surface* surface) {
+    Uint32 sum = 2166136261u;
+    for (int e = 0; e < NUM_ELEMENTS; e++) {
+        for (int t = 0; t < TEXTS_PER_ELEMENT; t++) {
+            int count;
+            const SL_TextLine* lines = SL_GetTextLines(elements[e], text_ids[t], &count);
+            for (int l = 0; l < count; l++) {
+                sum = (sum ^ (Uint32)(lines[l].start * 31 + lines[l].end * 17 + lines[l].width + lines[l].baseline)) * 16777619u;
+            }
+        }
+    }
+    const Uint32* pixels = surface->pixels;
+    for (int i = 0; i < surface->w * surface->h; i++) {
+        sum = (sum ^ pixels[i]) * 16777619u;
+    }
+    return sum;
+}
+
+// Milliseconds per frame spent getting text ready, every text resized each frame so all of it is redone
+static double runRounds(SL_UIElement** elements, SDL_Renderer* renderer, int rounds) {
+    double total = 0;
+
+    for (int r = 0; r < rounds + WARMUP_ROUNDS; r++) {
+        for (int e = 0; e < NUM_ELEMENTS; e++) {
+            for (int t = 0; t < TEXTS_PER_ELEMENT; t++) {
+                SL_SetTextSize(elements[e], text_ids[t], (r & 1) ? 8.0f : 9.0f);
+            }
+        }
+
+        SDL_RenderClear(renderer);
+        SL_BeginFrame();
+        double start = benchNow();
+        SL_PrepareElements(elements, NUM_ELEMENTS);
+        double end = benchNow();
+        for (int e = 0; e < NUM_ELEMENTS; e++) {
+            SL_DrawElement(elements[e]);
+        }
+        SL_EndFrame();
+
+        if (r >= WARMUP_ROUNDS) {
+            total += end - start;
+        }
+    }
+    return total * 1e3 / rounds;
+}
+
+int main(int argc, char** argv) {
+    int rounds = argc > 1 ? atoi(argv[1]) : 50;
+    if (rounds <= 0) rounds = 50;
+
+    SDL_Surface* surface;
+    SDL_Renderer* renderer = benchCreateRenderer(SCREEN_W, SCREEN_H, &surface);
+    SL_Init(renderer, SCREEN_W, SCREEN_H, SL_FLAGS_MANAGE_MEMORY);
+    SL_SetFrameArenaCapacity(32 << 20);
+
+    SDL_Texture* skin = benchCreateTexture(renderer, 96, 96);
+    SDL_Texture* font_tex = benchCreateTexture(renderer, 512, 512);
+    SL_Font* font = SL_LoadFont(font_tex, BENCH_FONT_PATH);
+    if (!font) {
+        fprintf(stderr, "Couldn't load font: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    char text[GLYPHS_PER_TEXT + 1];
+    for (int i = 0; i < GLYPHS_PER_TEXT; i++) {
+        text[i] = (i % 7 == 6) ? ' ' : (char)('a' + (i * 7) % 26);
+    }
+    text[GLYPHS_PER_TEXT] = '\0';
+
+    // Every other panel is narrower, so some jobs are bigger than others and stealing has something to do
+    SL_UIElement* elements[NUM_ELEMENTS];
+    for (int e = 0; e < NUM_ELEMENTS; e++) {
+        SL_UIElementBuilder* b = SL_CreateBuilder(skin);
+        int x = (e % 8) * SCREEN_W / 8, y = (e / 8) * SCREEN_H / 8;
+        int w = (e & 1) ? SCREEN_W / 16 : SCREEN_W / 8, h = SCREEN_H / 8;
+        SL_BuilderSetDimensionsAbsolute(b, &x, &y, &w, &h);
+        SL_BuilderUseFont(b, font);
+        for (int t = 0; t < TEXTS_PER_ELEMENT; t++) {
+            SL_BuilderAddTextObject(b, text, 2, 2 + t * 20, 8, text_ids[t]);
+        }
+        elements[e] = SL_CreateElement(&b);
+    }
+
+    printf("%d elements x %d texts x %d glyphs, %d rounds\n", NUM_ELEMENTS, TEXTS_PER_ELEMENT, GLYPHS_PER_TEXT, rounds);
+    double base = 0;
+    for (int i = 0; i < (int)(sizeof(thread_counts) / sizeof(thread_counts[0])); i++) {
+        if (SL_SetJobThreads(thread_counts[i]) != 0) {
+            fprintf(stderr, "Couldn't start %d threads: %s\n", thread_counts[i], SDL_GetError());
+            return 1;
+        }
+        double ms = runRounds(elements, renderer, rounds);
+        if (i == 0) base = ms;
+        printf("  %d threads  %8.3f ms/frame  %5.2fx  checksum %08x\n", SL_GetJobThreads(), ms, base / ms,
+               checksum(elements, surface));
+    }
+
+    SL_ReleaseFont(font);
+    SL_Quit();
+    SDL_DestroyRenderer(renderer);
+    SDL_FreeSurface(surface);
+    return 0;
+}
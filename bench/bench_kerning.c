@@ -0,0 +1,97 @@
+//
+// Layout throughput on large strings with kerning on and off, through a generated font with a pair for
+// every combination of letters
+//
+
+#include "bench_common.h"
+#include "Sliggy.h"
+#include <string.h>
+
+#define TEXT_BYTES (1 << 20)
+#define FONT_PATH "bench_kerning.fnt"
+#define ROUNDS 5
+
+static const char letters[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
+
+static void writeFont(void) {
+    FILE* file = fopen(FONT_PATH, "w");
+    if (!file) {
+        fprintf(stderr, "Couldn't write %s\n", FONT_PATH);
+        exit(1);
+    }
+    int num_letters = (int)strlen(letters);
+    fprintf(file, "info face=\"Bench\" size=32\n");
+    fprintf(file, "common lineHeight=40 base=32 scaleW=512 scaleH=512 pages=1\n");
+    fprintf(file, "chars count=%d\n", 0x7E - 0x20 + 1);
+    for (int cp = 0x20; cp <= 0x7E; cp++) {
+        int n = cp - 0x20;
+        fprintf(file, "char id=%d x=%d y=%d width=30 height=32 xoffset=1 yoffset=0 xadvance=32\n",
+                cp, (n % 16) * 32, (n / 16) * 32);
+    }
+    fprintf(file, "kernings count=%d\n", num_letters * num_letters);
+    for (int a = 0; a < num_letters; a++) {
+        for (int b = 0; b < num_letters; b++) {
+            fprintf(file, "kerning first=%d second=%d amount=%d\n", letters[a], letters[b], -((a + b) % 4));
+        }
+    }
+    fclose(file);
+}
+
+// Relayout is forced by resizing the element, so each round redoes word measuring, line breaks and quads
+static double layoutRound(SL_UIElement* element, int width) {
+    double start = benchNow();
+    SL_SetDimensionsAbsolute(element, NULL, NULL, &width, NULL);
+    SL_BeginFrame();
+    SL_DrawElement(element);
+    double end = benchNow();
+    SL_EndFrame();
+    return end - start;
+}
+
+int main(void) {
+    writeFont();
+    char* text = malloc(TEXT_BYTES);
+    int len = 0;
+    unsigned seed = 1;
+    while (len < TEXT_BYTES - 16) {
+        int word = 2 + (int)((seed = seed * 1103515245u + 12345u) >> 16) % 9;
+        for (int i = 0; i < word; i++) {
+            seed = seed * 1103515245u + 12345u;
+            text[len++] = letters[(seed >> 16) % (sizeof(letters) - 1)];
+        }
+        text[len++] = ' ';
+    }
+    text[len] = '\0';
+
+    SL_Init(NULL, 1280, 720, 0);
+    SL_Font* font = SL_LoadFont(NULL, FONT_PATH);
+
+    SL_UIElementBuilder* b = SL_CreateBuilder(NULL);
+    int x = 0;
+    int y = 0;
+    int w = 1280;
+    int h = 720;
+    SL_BuilderSetDimensionsAbsolute(b, &x, &y, &w, &h);
+    SL_BuilderUseFont(b, font);
+    SL_BuilderAddTextObject(b, text, 0, 0, 16, "text");
+    SL_UIElement* element = SL_CreateElement(&b);
+
+    for (int kerning = 0; kerning <= 1; kerning++) {
+        SL_FontSetKerning(font, kerning);
+        layoutRound(element, 1279); // warm up, and pick up the kerning change
+        double best = 1e9;
+        for (int r = 0; r < ROUNDS; r++) {
+            double t = layoutRound(element, 1280 - (r & 1));
+            if (t < best) best = t;
+        }
+        printf("kerning %-3s: %7.2f ms per 1 MB layout, %6.1f MB/s\n", kerning ? "on" : "off",
+               best * 1e3, (double)len / (1 << 20) / best);
+    }
+
+    SL_FreeElement(element);
+    SL_ReleaseFont(font);
+    SL_Quit();
+    free(text);
+    remove(FONT_PATH);
+    return 0;
+}
@@ -0,0 +1,107 @@
+//
+// Repeated labels - a screen of buttons and inventory cells where a handful of strings show up hundreds of times.
+// Builds and draws it with the shape cache on and off, for the time spent and the memory held
+//
+// sliggy_bench_labels [elements] [rounds]
+//
+
+#include "bench_common.h"
+#include "Sliggy.h"
+
+#define SCREEN_W 1280
+#define SCREEN_H 720
+#define CELL_W 120
+#define CELL_H 40
+#define MAX_ELEMENTS 8192
+
+static const char* labels[] = {
+        "OK", "Cancel", "Equip", "Drop", "Use", "Sell", "Potion", "Hi-Potion", "Ether", "Phoenix Down",
+        "Iron sword", "Leather armour", "Empty", "Locked"
+};
+#define NUM_LABELS (int)(sizeof(labels) / sizeof(labels[0]))
+
+typedef struct RunResult {
+    double build_us; // per element
+    double draw_us; // first frame, which is where the geometry gets built
+    size_t text_bytes;
+    size_t shape_bytes;
+} RunResult;
+
+static RunResult runScreen(SL_Font* font, SDL_Texture* skin, SL_UIElement** elements, int count, int rounds) {
+    RunResult result = {0, 0, 0, 0};
+    for (int round = 0; round < rounds; round++) {
+        double start = benchNow();
+        for (int i = 0; i < count; i++) {
+            SL_UIElementBuilder* b = SL_CreateBuilder(skin);
+            int x = (i % (SCREEN_W / CELL_W)) * CELL_W, y = (i / (SCREEN_W / CELL_W)) % (SCREEN_H / CELL_H) * CELL_H;
+            int w = CELL_W - 4, h = CELL_H - 4;
+            SL_BuilderSetDimensionsAbsolute(b, &x, &y, &w, &h);
+            SL_BuilderUseFont(b, font);
+            SL_BuilderAddTextObject(b, labels[i % NUM_LABELS], 4, 4, 8, "label");
+            SL_BuilderAddTextObject(b, labels[(i / NUM_LABELS) % NUM_LABELS], 4, 20, 8, "action");
+            elements[i] = SL_CreateElement(&b);
+        }
+        double built = benchNow();
+        SL_BeginFrame();
+        for (int i = 0; i < count; i++) {
+            SL_DrawElement(elements[i]);
+        }
+        SL_EndFrame();
+        double drawn = benchNow();
+
+        result.build_us += (built - start) * 1e6 / count;
+        result.draw_us += (drawn - built) * 1e6;
+        if (round == rounds - 1) {
+            SL_MemoryStats mem = SL_GetMemoryStats();
+            result.text_bytes = mem.text;
+            result.shape_bytes = mem.shapes;
+        }
+        SL_FreeElements(elements, count);
+    }
+    result.build_us /= rounds;
+    result.draw_us /= rounds;
+    return result;
+}
+
+int main(int argc, char** argv) {
+    int count = argc > 1 ? atoi(argv[1]) : 2000;
+    int rounds = argc > 2 ? atoi(argv[2]) : 20;
+    if (count <= 0 || count > MAX_ELEMENTS) count = 2000;
+    if (rounds <= 0) rounds = 20;
+
+    SDL_Surface* surface;
+    SDL_Renderer* renderer = benchCreateRenderer(SCREEN_W, SCREEN_H, &surface);
+    SL_Init(renderer, SCREEN_W, SCREEN_H, SL_FLAGS_MANAGE_MEMORY);
+
+    SDL_Texture* skin = benchCreateTexture(renderer, 96, 96);
+    SDL_Texture* font_tex = benchCreateTexture(renderer, 512, 512);
+    SL_Font* font = SL_LoadFont(font_tex, BENCH_FONT_PATH);
+    if (!font) {
+        fprintf(stderr, "Couldn't load font: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    static SL_UIElement* elements[MAX_ELEMENTS];
+    printf("%d elements x 2 labels out of %d strings, %d rounds of build, draw, free\n", count, NUM_LABELS, rounds);
+
+    SL_SetShapeCacheBudget(0);
+    RunResult off = runScreen(font, skin, elements, count, rounds);
+    printf("  cache off  build %6.2f us/element  first draw %8.1f us  text KB %8.1f\n", off.build_us, off.draw_us,
+           off.text_bytes / 1024.0);
+
+    // Trimmed in between so pooled slots from the last run don't bring their glyph buffers along
+    SL_TrimElementPool();
+    SL_SetShapeCacheBudget(256 << 10);
+    RunResult on = runScreen(font, skin, elements, count, rounds);
+    SL_ShapeCacheStats stats = SL_GetShapeCacheStats();
+    printf("  cache on   build %6.2f us/element  first draw %8.1f us  text KB %8.1f  cache KB %.1f\n", on.build_us,
+           on.draw_us, on.text_bytes / 1024.0, on.shape_bytes / 1024.0);
+    printf("  %lld hits, %lld misses, %d runs\n", stats.hits, stats.misses, stats.runs);
+
+    SL_TrimElementPool();
+    SL_ReleaseFont(font);
+    SL_Quit();
+    SDL_DestroyRenderer(renderer);
+    SDL_FreeSurface(surface);
+    return 0;
+}
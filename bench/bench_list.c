@@ -0,0 +1,118 @@
+//
+// Virtual list scrolling at 1k, 10k and 100k rows - the per-frame cost should stay flat as the row count grows.
+// For scale, also builds the same rows as plain elements with one text each
+//
+// sliggy_bench_list [frames]
+//
+
+#include "bench_common.h"
+#include "Sliggy.h"
+
+#define SCREEN_W 1280
+#define SCREEN_H 720
+#define ROW_HEIGHT 18
+#define WARMUP_FRAMES 20
+#define SCROLL_SPEED 7 // pixels a frame, so most frames bring a row in part way
+
+static const int row_counts[] = {1000, 10000, 100000};
+
+typedef struct RowSource {
+    char name[32];
+    char players[16];
+    int calls;
+} RowSource;
+
+static void fillRow(SL_UIElement* list, int row, SL_ListRow* out, void* userdata) {
+    (void)list;
+    RowSource* src = userdata;
+    snprintf(src->name, sizeof(src->name), "Server %06d", row);
+    snprintf(src->players, sizeof(src->players), "%d/32", row % 33);
+    out->columns[0] = src->name;
+    out->columns[1] = src->players;
+    src->calls++;
+}
+
+int main(int argc, char** argv) {
+    int frames = argc > 1 ? atoi(argv[1]) : 500;
+    if (frames <= 0) frames = 500;
+
+    SDL_Surface* surface;
+    SDL_Renderer* renderer = benchCreateRenderer(SCREEN_W, SCREEN_H, &surface);
+    SL_Init(renderer, SCREEN_W, SCREEN_H, SL_FLAGS_MANAGE_MEMORY);
+
+    SDL_Texture* skin = benchCreateTexture(renderer, 96, 96);
+    SDL_Texture* font_tex = benchCreateTexture(renderer, 512, 512);
+    SL_Font* font = SL_LoadFont(font_tex, BENCH_FONT_PATH);
+    if (!font) {
+        fprintf(stderr, "Couldn't load font: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    printf("%dx%d list, %d px rows, %d frames scrolling %d px a frame\n", SCREEN_W / 2, SCREEN_H, ROW_HEIGHT, frames,
+           SCROLL_SPEED);
+    for (int i = 0; i < (int)(sizeof(row_counts) / sizeof(row_counts[0])); i++) {
+        RowSource src = {{0}, {0}, 0};
+        SL_UIElementBuilder* b = SL_CreateBuilder(skin);
+        int x = 0, y = 0, w = SCREEN_W / 2, h = SCREEN_H;
+        int columns[2] = {4, SCREEN_W / 2 - 80};
+        SL_BuilderSetDimensionsAbsolute(b, &x, &y, &w, &h);
+        SL_BuilderUseFont(b, font);
+        SL_BuilderSetListColumns(b, columns, 2);
+        SL_BuilderSetList(b, row_counts[i], ROW_HEIGHT, 8, fillRow, &src);
+        SL_UIElement* list = SL_CreateElement(&b);
+
+        double total = 0;
+        long long allocations = 0;
+        for (int f = 0; f < frames + WARMUP_FRAMES; f++) {
+            SL_BeginFrame();
+            double start = benchNow();
+            SL_SetListScroll(list, f * SCROLL_SPEED);
+            SL_DrawElement(list);
+            double end = benchNow();
+            SL_EndFrame();
+            if (f == WARMUP_FRAMES - 1) src.calls = 0;
+            if (f >= WARMUP_FRAMES) {
+                total += end - start;
+                allocations += SL_GetFrameStats().allocations;
+            }
+        }
+        SL_MemoryStats mem = SL_GetMemoryStats();
+        printf("  %6d rows  %7.2f us/frame  %5.2f rows filled/frame  %lld allocations  memory KB text %.1f elements %.1f\n",
+               row_counts[i], total * 1e6 / frames, (double)src.calls / frames, allocations, mem.text / 1024.0,
+               mem.elements / 1024.0);
+        SL_FreeElement(list);
+        SL_TrimElementPool();
+    }
+
+    // The same rows as elements, only up to 10k since that's already the point
+    int count = 10000;
+    SL_UIElement** rows = malloc(count * sizeof(SL_UIElement*));
+    char name[32];
+    double start = benchNow();
+    for (int r = 0; r < count; r++) {
+        SL_UIElementBuilder* b = SL_CreateBuilder(NULL);
+        int x = 0, y = r * ROW_HEIGHT, w = SCREEN_W / 2, h = ROW_HEIGHT;
+        SL_BuilderSetDimensionsAbsolute(b, &x, &y, &w, &h);
+        SL_BuilderUseFont(b, font);
+        snprintf(name, sizeof(name), "Server %06d", r);
+        SL_BuilderAddTextObject(b, name, 4, 0, 8, "name");
+        rows[r] = SL_CreateElement(&b);
+    }
+    double built = benchNow() - start;
+    SL_BeginFrame();
+    for (int r = 0; r < count; r++) {
+        SL_DrawElement(rows[r]);
+    }
+    SL_EndFrame();
+    SL_MemoryStats mem = SL_GetMemoryStats();
+    printf("  %6d elements instead: %.2f ms to build, memory KB text %.1f elements %.1f\n", count, built * 1e3,
+           mem.text / 1024.0, mem.elements / 1024.0);
+
+    SL_FreeElements(rows, count);
+    free(rows);
+    SL_ReleaseFont(font);
+    SL_Quit();
+    SDL_DestroyRenderer(renderer);
+    SDL_FreeSurface(surface);
+    return 0;
+}
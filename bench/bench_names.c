@@ -0,0 +1,72 @@
+//
+// Element name index - create, hit and miss lookups from 10k up to 1M names, by string and by interned id
+//
+
+#include "bench_common.h"
+#include "Sliggy.h"
+
+#define NAME_LEN 24
+
+static void runSize(int n) {
+    char* names = malloc((size_t)n * NAME_LEN);
+    char* misses = malloc((size_t)n * NAME_LEN);
+    for (int i = 0; i < n; i++) {
+        snprintf(names + (size_t)i * NAME_LEN, NAME_LEN, "element_%d", i);
+        snprintf(misses + (size_t)i * NAME_LEN, NAME_LEN, "missing_%d", i);
+    }
+
+    SL_Init(NULL, 1280, 720, SL_FLAGS_MANAGE_MEMORY);
+
+    double start = benchNow();
+    for (int i = 0; i < n; i++) {
+        SL_UIElementBuilder* b = SL_CreateBuilder(NULL);
+        SL_BuilderSetName(b, names + (size_t)i * NAME_LEN);
+        SL_CreateElement(&b);
+    }
+    double created = benchNow();
+
+    // Stride through the names so consecutive lookups don't share cache lines
+    int found = 0;
+    unsigned idx = 0;
+    for (int i = 0; i < n; i++) {
+        idx = (idx + 7919) % (unsigned)n;
+        found += getElementFromMap(names + (size_t)idx * NAME_LEN) != NULL;
+    }
+    double hits = benchNow();
+
+    int missed = 0;
+    for (int i = 0; i < n; i++) {
+        missed += getElementFromMap(misses + (size_t)i * NAME_LEN) == NULL;
+    }
+    double end = benchNow();
+
+    // Ids would normally be interned once at load time, so that's not part of the timing
+    SL_Id* ids = malloc(n * sizeof(SL_Id));
+    for (int i = 0; i < n; i++) {
+        ids[i] = SL_Intern(names + (size_t)i * NAME_LEN);
+    }
+    double id_start = benchNow();
+    idx = 0;
+    for (int i = 0; i < n; i++) {
+        idx = (idx + 7919) % (unsigned)n;
+        found += SL_GetElementById(ids[idx]) != NULL;
+    }
+    double id_end = benchNow();
+
+    printf("%8d names: create %7.1f ns/op, hit %6.1f ns/op, miss %6.1f ns/op, id hit %6.1f ns/op%s\n", n,
+           (created - start) / n * 1e9, (hits - created) / n * 1e9, (end - hits) / n * 1e9,
+           (id_end - id_start) / n * 1e9, (found == 2 * n && missed == n) ? "" : "  (LOOKUP MISMATCH)");
+
+    SL_Quit();
+    free(ids);
+    free(names);
+    free(misses);
+}
+
+int main(int argc, char** argv) {
+    int max = argc > 1 ? atoi(argv[1]) : 1000000;
+    for (int n = 10000; n <= max; n *= 10) {
+        runSize(n);
+    }
+    return 0;
+}
@@ -0,0 +1,140 @@
+//
+// Element pool churn - list rows created and destroyed in bulk every frame, like an inventory being scrolled.
+// Checks handles go stale when they should, that churn stops allocating once the pool has warmed up, and that
+// everything comes back once it's all freed. Exits non-zero if any of that fails, build with -DSLIGGY_SANITIZE=ON
+// to have ASan check the teardown too
+//
+// sliggy_bench_pool [frames] [rows]
+//
+
+#include "bench_common.h"
+#include "Sliggy.h"
+
+#define SCREEN_W 1280
+#define SCREEN_H 720
+#define WARMUP_FRAMES 300 // long enough for most slots to have held their longest row once
+#define CHURN_DIVISOR 4 // a quarter of the rows are replaced each frame
+#define MAX_ROWS 4096
+
+static const char* row_texts[] = {
+        "Potion", "Hi-Potion x12", "Rusty sword of the long forgotten king", "Ether", "",
+        "A scroll with something written on it in a language nobody reads anymore"
+};
+#define NUM_ROW_TEXTS (int)(sizeof(row_texts) / sizeof(row_texts[0]))
+
+static Uint32 rng = 0x9E3779B9u;
+
+static Uint32 nextRandom(void) {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+static SL_UIElementBuilder* rowBuilder(SDL_Texture* skin, SL_Font* font, int y) {
+    SL_UIElementBuilder* b = SL_CreateBuilder(skin);
+    int x = 0, w = SCREEN_W / 2, h = 24;
+    SL_BuilderSetDimensionsAbsolute(b, &x, &y, &w, &h);
+    SL_BuilderUseFont(b, font);
+    SL_BuilderSetActive(b, 1);
+    // One to three texts of varying length, so slots get reused by rows that don't look like their last one
+    int texts = 1 + (int)(nextRandom() % 3);
+    for (int t = 0; t < texts; t++) {
+        const char* ids[] = {"name", "count", "desc"};
+        SL_BuilderAddTextObject(b, row_texts[nextRandom() % NUM_ROW_TEXTS], 4 + t * 200, 4, 8, ids[t]);
+    }
+    return b;
+}
+
+int main(int argc, char** argv) {
+    int frames = argc > 1 ? atoi(argv[1]) : 500;
+    int rows = argc > 2 ? atoi(argv[2]) : 512;
+    if (frames <= 0) frames = 500;
+    if (rows < CHURN_DIVISOR || rows > MAX_ROWS) rows = 512;
+    int churn = rows / CHURN_DIVISOR;
+
+    SDL_Surface* surface;
+    SDL_Renderer* renderer = benchCreateRenderer(SCREEN_W, SCREEN_H, &surface);
+    SL_Init(renderer, SCREEN_W, SCREEN_H, SL_FLAGS_MANAGE_MEMORY);
+
+    SDL_Texture* skin = benchCreateTexture(renderer, 96, 96);
+    SDL_Texture* font_tex = benchCreateTexture(renderer, 512, 512);
+    SL_Font* font = SL_LoadFont(font_tex, BENCH_FONT_PATH);
+    if (!font) {
+        fprintf(stderr, "Couldn't load font: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    static SL_UIElement* live[MAX_ROWS];
+    static SL_Handle handles[MAX_ROWS];
+    static SL_Handle stale[MAX_ROWS];
+    SL_UIElement* batch[MAX_ROWS / CHURN_DIVISOR];
+
+    SL_UIElementBuilder* b = rowBuilder(skin, font, 0);
+    SL_CreateElements(&b, rows, live);
+    for (int i = 0; i < rows; i++) {
+        handles[i] = SL_GetElementHandle(live[i]);
+    }
+
+    int failures = 0;
+    long long allocations = 0;
+    double create_time = 0;
+    double free_time = 0;
+
+    for (int f = 0; f < frames + WARMUP_FRAMES; f++) {
+        // Built before the frame starts so its allocations don't count against the pool
+        int first = (int)(nextRandom() % (Uint32)(rows - churn + 1));
+        b = rowBuilder(skin, font, (first % 30) * 24);
+        SL_BeginFrame();
+
+        // Drop a random run of rows, then refill it in one go from a single builder
+        for (int i = 0; i < churn; i++) {
+            batch[i] = live[first + i];
+            stale[i] = handles[first + i];
+        }
+        double start = benchNow();
+        SL_FreeElements(batch, churn);
+        double mid = benchNow();
+        SL_CreateElements(&b, churn, batch);
+        double end = benchNow();
+
+        for (int i = 0; i < churn; i++) {
+            live[first + i] = batch[i];
+            handles[first + i] = SL_GetElementHandle(batch[i]);
+            // The slot's most likely been reused, but not by anything the old handle should find
+            if (SL_GetElementByHandle(stale[i]) != NULL) failures++;
+        }
+        for (int i = 0; i < rows; i++) {
+            if (SL_GetElementByHandle(handles[i]) != live[i]) failures++;
+            SL_DrawElement(live[i]);
+        }
+        SL_EndFrame();
+
+        if (f >= WARMUP_FRAMES) {
+            free_time += mid - start;
+            create_time += end - mid;
+            allocations += SL_GetFrameStats().allocations;
+        }
+    }
+
+    double allocs_per_frame = (double)allocations / frames;
+    printf("%d rows, %d replaced a frame, %d frames\n", rows, churn, frames);
+    printf("  create      %8.1f ns per element\n", create_time * 1e9 / ((double)frames * churn));
+    printf("  free        %8.1f ns per element\n", free_time * 1e9 / ((double)frames * churn));
+    printf("  allocations %8.2f per frame\n", allocs_per_frame);
+
+    SL_FreeElements(live, rows);
+    SL_TrimElementPool();
+    SL_MemoryStats mem = SL_GetMemoryStats();
+    printf("  after trim  text %zu bytes\n", mem.text);
+
+    if (failures) fprintf(stderr, "FAIL: %d handle lookups came back wrong\n", failures);
+    if (allocs_per_frame > 1.0) fprintf(stderr, "FAIL: churn still allocating once warmed up\n");
+    if (mem.text != 0) fprintf(stderr, "FAIL: text memory left after freeing everything\n");
+
+    SL_ReleaseFont(font);
+    SL_Quit();
+    SDL_DestroyRenderer(renderer);
+    SDL_FreeSurface(surface);
+    return failures || allocs_per_frame > 1.0 || mem.text != 0;
+}
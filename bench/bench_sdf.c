@@ -0,0 +1,84 @@
+//
+// Distance field fonts - what it costs to generate the field, to rasterise each size the first time text asks for
+// it, and how much texture memory a spread of sizes takes against shipping a bitmap atlas per size
+//
+// sliggy_bench_sdf [spread]
+//
+
+#include "bench_common.h"
+#include "Sliggy.h"
+
+#define SCREEN_W 1280
+#define SCREEN_H 720
+#define FONT_PAGE_SIZE 512 // Font2.png
+#define SMALLEST_SIZE 8
+#define LARGEST_SIZE 64
+#define SIZE_STEP 4
+#define SDF_FONT_PATH "bench_sdf.fnt" // written next to wherever this runs from
+
+int main(int argc, char** argv) {
+    int spread = argc > 1 ? atoi(argv[1]) : 4;
+    if (spread <= 0) spread = 4;
+
+    SDL_Surface* surface;
+    SDL_Renderer* renderer = benchCreateRenderer(SCREEN_W, SCREEN_H, &surface);
+    SL_Init(renderer, SCREEN_W, SCREEN_H, SL_FLAGS_MANAGE_MEMORY);
+
+    // A blank page has the same glyph rects as the real one, which is all the timings depend on
+    SDL_Surface* page = SDL_CreateRGBSurfaceWithFormat(0, FONT_PAGE_SIZE, FONT_PAGE_SIZE, 32, SDL_PIXELFORMAT_RGBA32);
+    double start = benchNow();
+    SDL_Surface* field = SL_GenerateSdfFont(BENCH_FONT_PATH, page, spread, SDF_FONT_PATH, "bench_sdf.bmp", NULL, NULL);
+    double generated = benchNow() - start;
+    SDL_FreeSurface(page);
+    if (!field) {
+        fprintf(stderr, "Couldn't generate the field: %s\n", SDL_GetError());
+        return 1;
+    }
+    SL_Font* font = SL_LoadSdfFont(field, SDF_FONT_PATH);
+    if (!font) {
+        fprintf(stderr, "Couldn't load the field: %s\n", SDL_GetError());
+        return 1;
+    }
+    printf("spread %d: generated a %dx%d field in %.1f ms\n", spread, field->w, field->h, generated * 1e3);
+
+    // One text per size, all kept so nothing gets evicted. Creating the element is what rasterises its size
+    int sizes = (LARGEST_SIZE - SMALLEST_SIZE) / SIZE_STEP + 1;
+    SL_UIElement* texts[(LARGEST_SIZE - SMALLEST_SIZE) / SIZE_STEP + 1];
+    double raster_total = 0;
+    size_t texture_bytes = 0;
+    for (int s = 0; s < sizes; s++) {
+        int size = SMALLEST_SIZE + s * SIZE_STEP;
+        SL_UIElementBuilder* b = SL_CreateBuilder(NULL);
+        int x = 0, y = 0, w = SCREEN_W, h = SCREEN_H;
+        SL_BuilderSetDimensionsAbsolute(b, &x, &y, &w, &h);
+        SL_BuilderUseFont(b, font);
+        SL_BuilderAddTextObject(b, "The quick brown fox", 4, 4, (float)size, "text");
+        start = benchNow();
+        texts[s] = SL_CreateElement(&b);
+        double took = benchNow() - start;
+        raster_total += took;
+
+        size_t bytes = SL_GetMemoryStats().textures - texture_bytes;
+        texture_bytes += bytes;
+        printf("  %3dpx  first use %7.2f ms  %7.1f KB texture\n", size, took * 1e3, bytes / 1024.0);
+    }
+
+    SL_BeginFrame();
+    for (int s = 0; s < sizes; s++) {
+        SL_DrawElement(texts[s]);
+    }
+    SL_EndFrame();
+
+    size_t bitmap_bytes = (size_t)sizes * FONT_PAGE_SIZE * FONT_PAGE_SIZE * 4;
+    printf("%d sizes: %.1f ms rasterising, %.1f KB of textures plus a %.1f KB field on the CPU\n", sizes,
+           raster_total * 1e3, texture_bytes / 1024.0, field->w * field->h / 1024.0);
+    printf("  against %.1f KB for a %dx%d atlas per size\n", bitmap_bytes / 1024.0, FONT_PAGE_SIZE, FONT_PAGE_SIZE);
+
+    SL_FreeElements(texts, sizes);
+    SDL_FreeSurface(field);
+    SL_ReleaseFont(font);
+    SL_Quit();
+    SDL_DestroyRenderer(renderer);
+    SDL_FreeSurface(surface);
+    return 0;
+}
@@ -0,0 +1,105 @@
+//
+// Per-frame CPU cost of drawing static text, with and without the text geometry cache
+//
+
+#include "bench_common.h"
+#include "Sliggy.h"
+
+#define SCREEN_W 1280
+#define SCREEN_H 720
+#define NUM_ELEMENTS 20
+#define TEXTS_PER_ELEMENT 5
+#define GLYPHS_PER_TEXT 100
+#define WARMUP_FRAMES 10
+
+static const char* text_ids[TEXTS_PER_ELEMENT] = {"t0", "t1", "t2", "t3", "t4"};
+
+// Runs the frames and returns the average time spent in SL_DrawElement calls, in microseconds
+static double runFrames(SL_UIElement** elements, int frames, int invalidate, double* submit_us) {
+    double draw_total = 0;
+    double submit_total = 0;
+
+    for (int f = 0; f < frames + WARMUP_FRAMES; f++) {
+        // Flipping the alignment dirties the quads, which is the same as having no cache at all
+        if (invalidate) {
+            for (int e = 0; e < NUM_ELEMENTS; e++) {
+                for (int t = 0; t < TEXTS_PER_ELEMENT; t++) {
+                    SL_SetTextAlign(elements[e], text_ids[t], (f & 1) ? SL_TEXT_ALIGN_CENTER : SL_TEXT_ALIGN_LEFT);
+                }
+            }
+        }
+
+        double start = benchNow();
+        SL_BeginFrame();
+        for (int e = 0; e < NUM_ELEMENTS; e++) {
+            SL_DrawElement(elements[e]);
+        }
+        double drawn = benchNow();
+        SL_EndFrame();
+        double end = benchNow();
+
+        if (f >= WARMUP_FRAMES) {
+            draw_total += drawn - start;
+            submit_total += end - drawn;
+        }
+    }
+    *submit_us = submit_total / frames * 1e6;
+    return draw_total / frames * 1e6;
+}
+
+int main(int argc, char** argv) {
+    int frames = argc > 1 ? atoi(argv[1]) : 200;
+    if (frames <= 0) frames = 200;
+
+    SDL_Surface* surface;
+    SDL_Renderer* renderer = benchCreateRenderer(SCREEN_W, SCREEN_H, &surface);
+    SL_Init(renderer, SCREEN_W, SCREEN_H, 0);
+
+    SDL_Texture* skin = benchCreateTexture(renderer, 96, 96);
+    SDL_Texture* font = benchCreateTexture(renderer, 512, 512);
+
+    char text[GLYPHS_PER_TEXT + 1];
+    for (int i = 0; i < GLYPHS_PER_TEXT; i++) {
+        text[i] = (i % 8 == 7) ? ' ' : (char)('a' + i % 26);
+    }
+    text[GLYPHS_PER_TEXT] = '\0';
+
+    SL_UIElement* elements[NUM_ELEMENTS];
+    for (int e = 0; e < NUM_ELEMENTS; e++) {
+        SL_UIElementBuilder* b = SL_CreateBuilder(skin);
+        int x = (e % 5) * 250;
+        int y = (e / 5) * 175;
+        int w = 240;
+        int h = 170;
+        SL_BuilderSetDimensionsAbsolute(b, &x, &y, &w, &h);
+        SL_BuilderSetName(b, "bench");
+        SL_BuilderSetFont(b, font, BENCH_FONT_PATH);
+        for (int t = 0; t < TEXTS_PER_ELEMENT; t++) {
+            SL_BuilderAddTextObject(b, text, 4, 4 + t * 32, 8, text_ids[t]);
+        }
+        elements[e] = SL_CreateElement(&b);
+    }
+
+    int glyphs = NUM_ELEMENTS * TEXTS_PER_ELEMENT * GLYPHS_PER_TEXT;
+    double submit_us;
+
+    printf("%d static glyphs, %d frames\n", glyphs, frames);
+    double rebuild_us = runFrames(elements, frames, 1, &submit_us);
+    printf("  rebuild every frame: %9.1f us/frame building, %9.1f us/frame in SL_EndFrame\n", rebuild_us, submit_us);
+    double cached_us = runFrames(elements, frames, 0, &submit_us);
+    printf("  cached:              %9.1f us/frame building, %9.1f us/frame in SL_EndFrame\n", cached_us, submit_us);
+    printf("  speedup: %.2fx\n", rebuild_us / cached_us);
+
+    SL_FrameStats stats = SL_GetFrameStats();
+    printf("  %d draw calls, %d vertices per frame\n", stats.draw_calls, stats.vertices);
+
+    for (int e = 0; e < NUM_ELEMENTS; e++) {
+        SL_FreeElement(elements[e]);
+    }
+    SL_Quit();
+    SDL_DestroyTexture(skin);
+    SDL_DestroyTexture(font);
+    SDL_DestroyRenderer(renderer);
+    SDL_FreeSurface(surface);
+    return 0;
+}
@@ -0,0 +1,108 @@
+//
+// Layout of 1 MB of text, pure ASCII against mixed Latin/Polish/Cyrillic/Japanese, through a generated font
+// that covers all of them
+//
+
+#include "bench_common.h"
+#include "Sliggy.h"
+#include <string.h>
+
+#define TEXT_BYTES (1 << 20)
+#define FONT_PATH "bench_unicode.fnt"
+
+static const int ranges[][2] = {
+        {0x20, 0x7E}, // ASCII
+        {0x100, 0x17F}, // Latin Extended-A
+        {0x400, 0x4FF}, // Cyrillic
+        {0x3000, 0x30FF}, // CJK punctuation, hiragana, katakana
+        {0x4E00, 0x9FFF}, // CJK unified ideographs
+};
+
+// Metrics don't matter here, only that every codepoint has a glyph
+static void writeFont(void) {
+    FILE* file = fopen(FONT_PATH, "w");
+    if (!file) {
+        fprintf(stderr, "Couldn't write %s\n", FONT_PATH);
+        exit(1);
+    }
+    int count = 0;
+    for (size_t r = 0; r < sizeof(ranges) / sizeof(ranges[0]); r++) {
+        count += ranges[r][1] - ranges[r][0] + 1;
+    }
+    fprintf(file, "info face=\"Bench\" size=32\n");
+    fprintf(file, "common lineHeight=40 base=32 scaleW=4096 scaleH=4096 pages=1\n");
+    fprintf(file, "chars count=%d\n", count);
+    int n = 0;
+    for (size_t r = 0; r < sizeof(ranges) / sizeof(ranges[0]); r++) {
+        for (int cp = ranges[r][0]; cp <= ranges[r][1]; cp++, n++) {
+            fprintf(file, "char id=%d x=%d y=%d width=30 height=32 xoffset=1 yoffset=0 xadvance=32\n",
+                    cp, (n % 128) * 32, (n / 128) * 32);
+        }
+    }
+    fclose(file);
+}
+
+static void fillText(char* text, int mixed) {
+    static const char* words[] = {
+            "Hello", "world", "zażółć", "gęślą", "jaźń", "Привет", "мир", "こんにちは", "世界", "カタカナ", "漢字表示"
+    };
+    int num_words = mixed ? (int)(sizeof(words) / sizeof(words[0])) : 2;
+    int len = 0;
+    int w = 0;
+    while (1) {
+        const char* word = words[w++ % num_words];
+        int n = (int)strlen(word);
+        if (len + n + 1 >= TEXT_BYTES) break;
+        memcpy(text + len, word, n);
+        len += n;
+        text[len++] = ' ';
+    }
+    text[len] = '\0';
+}
+
+static void runLayout(const char* label, const char* text) {
+    SL_UIElementBuilder* b = SL_CreateBuilder(NULL);
+    int x = 0;
+    int y = 0;
+    int w = 1280;
+    int h = 720;
+    SL_BuilderSetDimensionsAbsolute(b, &x, &y, &w, &h);
+    SL_BuilderSetFont(b, NULL, FONT_PATH);
+    SL_BuilderAddTextObject(b, text, 0, 0, 16, "text");
+
+    // Decoding, glyph lookup and word measuring
+    double start = benchNow();
+    SL_UIElement* element = SL_CreateElement(&b);
+    double created = benchNow();
+
+    // Line breaking and quads, no renderer so SL_EndFrame has nothing to submit to
+    SL_BeginFrame();
+    SL_DrawElement(element);
+    double laid_out = benchNow();
+    SL_EndFrame();
+
+    SL_FrameStats stats = SL_GetFrameStats();
+    int glyphs = stats.vertices / 4 - 16 / 4;
+    double mb = (double)strlen(text) / (1 << 20);
+    printf("%-6s %7d glyphs: decode+lookup %7.2f ms (%6.1f MB/s), layout %7.2f ms, %5.1f ns/glyph total\n",
+           label, glyphs, (created - start) * 1e3, mb / (created - start), (laid_out - created) * 1e3,
+           (laid_out - start) / glyphs * 1e9);
+
+    SL_FreeElement(element);
+}
+
+int main(void) {
+    writeFont();
+    char* text = malloc(TEXT_BYTES);
+
+    SL_Init(NULL, 1280, 720, 0);
+    fillText(text, 0);
+    runLayout("ascii", text);
+    fillText(text, 1);
+    runLayout("mixed", text);
+    SL_Quit();
+
+    free(text);
+    remove(FONT_PATH);
+    return 0;
+}
@@ -61,8 +61,10 @@ int main(int argc, char** argv) {
         SDL_RenderClear(renderer);
 
         // Render
+        SL_BeginFrame();
         // SL_DrawElement(ele);
         SL_DrawElement(ele2);
+        SL_EndFrame();
 
         SDL_RenderPresent(renderer);
     }
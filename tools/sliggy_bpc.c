@@ -0,0 +1,19 @@
+//
+// Offline blueprint compiler - turns a text blueprint into the compiled form SL_LoadBlueprint reads without parsing
+//
+
+#include "SDL.h"
+#include "Sliggy.h"
+#include <stdio.h>
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        fprintf(stderr, "Usage: %s <input.bp> <output.slbp>\n", argv[0]);
+        return 1;
+    }
+    if (SL_CompileBlueprint(argv[1], argv[2]) != 0) {
+        fprintf(stderr, "%s\n", SDL_GetError());
+        return 1;
+    }
+    return 0;
+}
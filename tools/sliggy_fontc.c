@@ -0,0 +1,19 @@
+//
+// Offline font converter - turns an AngelCode .fnt into the binary form SL_BuilderSetFont maps directly
+//
+
+#include "SDL.h"
+#include "Sliggy.h"
+#include <stdio.h>
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        fprintf(stderr, "Usage: %s <input.fnt> <output.slf>\n", argv[0]);
+        return 1;
+    }
+    if (SL_CompileFont(argv[1], argv[2]) != 0) {
+        fprintf(stderr, "%s\n", SDL_GetError());
+        return 1;
+    }
+    return 0;
+}
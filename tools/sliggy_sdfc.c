@@ -0,0 +1,57 @@
+//
+// Offline distance field generator - turns a bitmap .fnt and its page into a distance field font for SL_LoadSdfFont.
+// Pngs need SDL_image, without it pages are read and written as bmp
+//
+
+#include "SDL.h"
+#include "Sliggy.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef SLIGGY_HAVE_SDL_IMAGE
+#include "SDL_image.h"
+
+static int endsWith(const char* str, const char* suffix) {
+    size_t len = strlen(str), suffix_len = strlen(suffix);
+    return len >= suffix_len && SDL_strcasecmp(str + len - suffix_len, suffix) == 0;
+}
+
+static int savePng(SDL_Surface* surface, const char* path, void* userdata) {
+    (void)userdata;
+    return IMG_SavePNG(surface, path);
+}
+#endif
+
+int main(int argc, char** argv) {
+    if (argc != 6) {
+        fprintf(stderr, "Usage: %s <input.fnt> <input page> <spread> <output.fnt> <output page>\n", argv[0]);
+        return 1;
+    }
+    int spread = atoi(argv[3]);
+
+#ifdef SLIGGY_HAVE_SDL_IMAGE
+    SDL_Surface* page = IMG_Load(argv[2]);
+#else
+    SDL_Surface* page = SDL_LoadBMP(argv[2]);
+#endif
+    if (!page) {
+        fprintf(stderr, "Couldn't load %s: %s\n", argv[2], SDL_GetError());
+        return 1;
+    }
+
+    // Bmp unless asked for a png, the saver is handed a temporary path so it can't go by the extension itself
+    SL_SurfaceSaver saver = NULL;
+#ifdef SLIGGY_HAVE_SDL_IMAGE
+    if (endsWith(argv[5], ".png")) {
+        saver = savePng;
+    }
+#endif
+    SDL_Surface* sdf = SL_GenerateSdfFont(argv[1], page, spread, argv[4], argv[5], saver, NULL);
+    SDL_FreeSurface(page);
+    if (!sdf) {
+        fprintf(stderr, "%s\n", SDL_GetError());
+        return 1;
+    }
+    SDL_FreeSurface(sdf);
+    return 0;
+}